@@ -11,7 +11,11 @@
  * @ignore
  */
 #include "./mysql_bindings_connection.h"
+#include "./mysql_bindings_pool.h"
 #include "./mysql_bindings_result.h"
+#include "./mysql_bindings_router.h"
+#include "./mysql_bindings_scheduler.h"
+#include "./mysql_bindings_shardmap.h"
 #include "./mysql_bindings_statement.h"
 
 /**
@@ -20,12 +24,20 @@
  * Classes to populate in JavaScript:
  *
  * * MysqlConnection
+ * * MysqlPool
  * * MysqlResult
+ * * MysqlRouter
+ * * MysqlScheduler
+ * * MysqlShardMap
  * * MysqlStatement
  */
 extern "C" void init(Handle<Object> target) {
     MysqlConnection::Init(target);
+    MysqlPool::Init(target);
     MysqlResult::Init(target);
+    MysqlRouter::Init(target);
+    MysqlScheduler::Init(target);
+    MysqlShardMap::Init(target);
     MysqlStatement::Init(target);
 }
 
@@ -84,5 +84,11 @@ if (!conn->multi_query) { \
         return THREXC("Not connected"); \
     }
 
+// Stream load waits in worker for main thread with query_lock held
+#define MYSQLCONN_MUSTNOT_LOAD_STREAM(conn) \
+    if ((conn)->stream_loads) { \
+        return THREXC("Connection is busy with loadData() from stream"); \
+    }
+
 #endif  // NODE_MYSQL_H  // NOLINT
 
@@ -20,6 +20,11 @@
  * @ignore
  */
 Persistent<FunctionTemplate> MysqlConnection::constructor_template;
+#ifndef MYSQL_NON_THREADSAFE
+Persistent<Function> MysqlConnection::load_data_on_data;
+Persistent<Function> MysqlConnection::load_data_on_end;
+Persistent<Function> MysqlConnection::load_data_on_error;
+#endif
 
 void MysqlConnection::Init(Handle<Object> target) {
     HandleScope scope;
@@ -56,6 +61,7 @@ void MysqlConnection::Init(Handle<Object> target) {
     // Methods
     ADD_PROTOTYPE_METHOD(connection, affectedRowsSync, AffectedRowsSync);
     ADD_PROTOTYPE_METHOD(connection, autoCommitSync, AutoCommitSync);
+    ADD_PROTOTYPE_METHOD(connection, bulkInsert, BulkInsert);
     ADD_PROTOTYPE_METHOD(connection, changeUserSync, ChangeUserSync);
     ADD_PROTOTYPE_METHOD(connection, commitSync, CommitSync);
     ADD_PROTOTYPE_METHOD(connection, connect, Connect);
@@ -66,6 +72,8 @@ void MysqlConnection::Init(Handle<Object> target) {
     ADD_PROTOTYPE_METHOD(connection, dumpDebugInfoSync, DumpDebugInfoSync);
     ADD_PROTOTYPE_METHOD(connection, errnoSync, ErrnoSync);
     ADD_PROTOTYPE_METHOD(connection, errorSync, ErrorSync);
+    ADD_PROTOTYPE_METHOD(connection, escapeBuffer, EscapeBuffer);
+    ADD_PROTOTYPE_METHOD(connection, escapeMany, EscapeMany);
     ADD_PROTOTYPE_METHOD(connection, escapeSync, EscapeSync);
     ADD_PROTOTYPE_METHOD(connection, fieldCountSync, FieldCountSync);
     ADD_PROTOTYPE_METHOD(connection, getCharsetSync, GetCharsetSync);
@@ -76,28 +84,46 @@ void MysqlConnection::Init(Handle<Object> target) {
     ADD_PROTOTYPE_METHOD(connection, initSync, InitSync);
     ADD_PROTOTYPE_METHOD(connection, initStatementSync, InitStatementSync);
     ADD_PROTOTYPE_METHOD(connection, lastInsertIdSync, LastInsertIdSync);
+    ADD_PROTOTYPE_METHOD(connection, loadData, LoadData);
+    ADD_PROTOTYPE_METHOD(connection, lookup, Lookup);
     ADD_PROTOTYPE_METHOD(connection, multiMoreResultsSync,
         MultiMoreResultsSync);
     ADD_PROTOTYPE_METHOD(connection, multiNextResultSync, MultiNextResultSync);
     ADD_PROTOTYPE_METHOD(connection, multiRealQuerySync, MultiRealQuerySync);
+    ADD_PROTOTYPE_METHOD(connection, ping, Ping);
     ADD_PROTOTYPE_METHOD(connection, pingSync, PingSync);
     ADD_PROTOTYPE_METHOD(connection, query, Query);
     ADD_PROTOTYPE_METHOD(connection, querySync, QuerySync);
     ADD_PROTOTYPE_METHOD(connection, realConnectSync, RealConnectSync);
     ADD_PROTOTYPE_METHOD(connection, realQuerySync, RealQuerySync);
+    ADD_PROTOTYPE_METHOD(connection, reset, Reset);
     ADD_PROTOTYPE_METHOD(connection, rollbackSync, RollbackSync);
     ADD_PROTOTYPE_METHOD(connection, selectDbSync, SelectDbSync);
     ADD_PROTOTYPE_METHOD(connection, setCharsetSync, SetCharsetSync);
+    ADD_PROTOTYPE_METHOD(connection, setKeepaliveSync, SetKeepaliveSync);
     ADD_PROTOTYPE_METHOD(connection, setOptionSync, SetOptionSync);
+    ADD_PROTOTYPE_METHOD(connection, setPrioritySync, SetPrioritySync);
+    ADD_PROTOTYPE_METHOD(connection, setReconnectSync, SetReconnectSync);
     ADD_PROTOTYPE_METHOD(connection, setSslSync, SetSslSync);
     ADD_PROTOTYPE_METHOD(connection, sqlStateSync, SqlStateSync);
     ADD_PROTOTYPE_METHOD(connection, statSync, StatSync);
     ADD_PROTOTYPE_METHOD(connection, storeResultSync, StoreResultSync);
     ADD_PROTOTYPE_METHOD(connection, threadIdSync, ThreadIdSync);
     ADD_PROTOTYPE_METHOD(connection, threadSafeSync, ThreadSafeSync);
+    ADD_PROTOTYPE_METHOD(connection, transaction, Transaction);
     ADD_PROTOTYPE_METHOD(connection, useResultSync, UseResultSync);
     ADD_PROTOTYPE_METHOD(connection, warningCountSync, WarningCountSync);
 
+#ifndef MYSQL_NON_THREADSAFE
+    // Native callbacks, bound to per-request data on each loadData() call
+    load_data_on_data = Persistent<Function>::New(
+        FunctionTemplate::New(LoadDataOnData)->GetFunction());
+    load_data_on_end = Persistent<Function>::New(
+        FunctionTemplate::New(LoadDataOnEnd)->GetFunction());
+    load_data_on_error = Persistent<Function>::New(
+        FunctionTemplate::New(LoadDataOnError)->GetFunction());
+#endif
+
     // Make it visible in JavaScript
     target->Set(String::NewSymbol("MysqlConnection"),
                 constructor_template->GetFunction());
@@ -130,8 +156,7 @@ bool MysqlConnection::Connect(const char* hostname,
                             0);
 
     if (unsuccessful) {
-        connect_errno = mysql_errno(_conn);
-        connect_error = mysql_error(_conn);
+        SetConnectError();
 
         mysql_close(_conn);
         connected = false;
@@ -139,6 +164,8 @@ bool MysqlConnection::Connect(const char* hostname,
         return false;
     }
 
+    SaveConnectArgs(hostname, user, password, dbname, port, socket);
+
     connected = true;
     return true;
 }
@@ -167,14 +194,16 @@ bool MysqlConnection::RealConnect(const char* hostname,
                                             0);
 
     if (unsuccessful) {
-        connect_errno = mysql_errno(_conn);
-        connect_error = mysql_error(_conn);
+        SetConnectError();
 
         mysql_close(_conn);
         connected = false;
+        _conn = NULL;
         return false;
     }
 
+    SaveConnectArgs(hostname, user, password, dbname, port, socket);
+
     connected = true;
     return true;
 }
@@ -184,9 +213,205 @@ void MysqlConnection::Close() {
         mysql_close(_conn);
         connected = false;
         _conn = NULL;
+        max_allowed_packet = 0;
+    }
+
+    FreeSavedState();
+}
+
+/**
+ * Reconnects with saved connect arguments, options and session state,
+ * retrying with exponential backoff and jitter. Called in worker thread
+ * with query_lock held
+ *
+ * @ignore
+ */
+bool MysqlConnection::Reconnect() {
+    unsigned int seed = time(NULL) ^ reinterpret_cast<uintptr_t>(this);
+
+    for (uint32_t attempt = 0; attempt < reconnect_attempts; attempt++) {
+        if (attempt) {
+            // Random delay in [delay/2, delay] spreads reconnects
+            // of many connections after failover
+            uint64_t delay = static_cast<uint64_t>(reconnect_delay) <<
+                             (attempt - 1 < 10 ? attempt - 1 : 10);
+            if (delay > 30000) {
+                delay = 30000;
+            }
+            delay = delay/2 + rand_r(&seed) % (delay/2 + 1);
+
+            struct timespec sleep_time;
+            sleep_time.tv_sec = delay/1000;
+            sleep_time.tv_nsec = (delay%1000)*1000000;
+            nanosleep(&sleep_time, NULL);
+        }
+
+        if (_conn) {
+            mysql_close(_conn);
+        }
+        connected = false;
+        multi_query = false;
+        max_allowed_packet = 0;
+
+        _conn = mysql_init(NULL);
+        if (!_conn) {
+            continue;
+        }
+
+        for (struct saved_option *option = saved_options;
+             option;
+             option = option->next) {
+            mysql_options(_conn, option->option, option->string_value ?
+                          option->string_value :
+                          static_cast<const char *>(
+                            static_cast<const void *>(
+                              &option->integer_value)));
+        }
+        if (saved_ssl_set) {
+            mysql_ssl_set(_conn, saved_ssl[0], saved_ssl[1], saved_ssl[2],
+                          saved_ssl[3], saved_ssl[4]);
+        }
+
+        if (!mysql_real_connect(_conn,
+                                saved_hostname,
+                                saved_user,
+                                saved_password,
+                                saved_dbname,
+                                saved_port,
+                                saved_socket,
+                                0)) {
+            SetConnectError();
+            continue;
+        }
+
+        if (saved_charset) {
+            mysql_set_character_set(_conn, saved_charset);
+        }
+        if (saved_autocommit >= 0) {
+            mysql_autocommit(_conn, saved_autocommit);
+        }
+
+        dbname_known = true;
+        charset_known = true;
+        connected = true;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Clears session state: rolls back transaction, drops temporary tables,
+ * user variables and locks, keeps selected database. Uses cheap
+ * mysql_reset_connection() if available, falls back to
+ * mysql_change_user() with saved credentials. Called in worker thread
+ * with query_lock held
+ *
+ * @ignore
+ */
+bool MysqlConnection::ResetSession(const char **error) {
+    bool r = true;
+
+#if MYSQL_VERSION_ID >= 50703
+    r = mysql_reset_connection(_conn) != 0;
+#endif
+
+    if (r) {
+        // Old client library or server without COM_RESET_CONNECTION
+        r = mysql_change_user(_conn, saved_user ? saved_user : "",
+                              saved_password, saved_dbname) != 0;
+    }
+
+    if (r) {
+        *error = mysql_error(_conn);
+        return false;
+    }
+
+    // Server session is back to defaults, client charset is restored
+    if (saved_charset) {
+        mysql_set_character_set(_conn, saved_charset);
+    }
+    saved_autocommit = -1;
+    multi_query = false;
+    dbname_known = true;
+    charset_known = true;
+
+    return true;
+}
+
+void MysqlConnection::SaveString(char **to, const char *from) {
+    free(*to);
+    *to = from ? strdup(from) : NULL;
+}
+
+void MysqlConnection::SaveConnectArgs(const char* hostname,
+                                      const char* user,
+                                      const char* password,
+                                      const char* dbname,
+                                      uint32_t port,
+                                      const char* socket) {
+    SaveString(&saved_hostname, hostname);
+    SaveString(&saved_user, user);
+    SaveString(&saved_password, password);
+    SaveString(&saved_dbname, dbname);
+    saved_port = port;
+    SaveString(&saved_socket, socket);
+    dbname_known = true;
+    charset_known = true;
+}
+
+void MysqlConnection::SaveOption(mysql_option option,
+                                 const char *string_value,
+                                 unsigned int integer_value) {
+    struct saved_option **last = &saved_options;
+
+    while (*last && (*last)->option != option) {
+        last = &(*last)->next;
+    }
+
+    if (!*last) {
+        *last = reinterpret_cast<struct saved_option *>(
+            calloc(1, sizeof(struct saved_option)));
+        if (!*last) {
+            return;
+        }
+        (*last)->option = option;
+    }
+
+    SaveString(&(*last)->string_value, string_value);
+    (*last)->integer_value = integer_value;
+}
+
+void MysqlConnection::FreeSavedState() {
+    SaveString(&saved_hostname, NULL);
+    SaveString(&saved_user, NULL);
+    SaveString(&saved_password, NULL);
+    SaveString(&saved_dbname, NULL);
+    saved_port = 0;
+    SaveString(&saved_socket, NULL);
+    SaveString(&saved_charset, NULL);
+    saved_autocommit = -1;
+    dbname_known = false;
+    charset_known = false;
+    for (int i = 0; i < 5; i++) {
+        SaveString(&saved_ssl[i], NULL);
+    }
+    saved_ssl_set = false;
+
+    while (saved_options) {
+        struct saved_option *next = saved_options->next;
+        free(saved_options->string_value);
+        free(saved_options);
+        saved_options = next;
     }
 }
 
+void MysqlConnection::SetConnectError() {
+    connect_errno = mysql_errno(_conn);
+    // Copy, error string is freed with connection handle
+    SaveString(&connect_error, mysql_error(_conn));
+}
+
 MysqlConnection::MysqlConnectionInfo MysqlConnection::GetInfo() {
     MysqlConnectionInfo info;
 
@@ -206,11 +431,48 @@ MysqlConnection::MysqlConnection(): EventEmitter() {
     multi_query = false;
     connect_errno = 0;
     connect_error = NULL;
+    max_allowed_packet = 0;
+    priority = EIO_PRI_DEFAULT;
+    reconnect = false;
+    reconnect_attempts = 5;
+    reconnect_delay = 100;
+    saved_hostname = NULL;
+    saved_user = NULL;
+    saved_password = NULL;
+    saved_dbname = NULL;
+    saved_port = 0;
+    saved_socket = NULL;
+    saved_charset = NULL;
+    saved_autocommit = -1;
+    saved_options = NULL;
+    dbname_known = false;
+    charset_known = false;
+    memset(saved_ssl, 0, sizeof(saved_ssl));
+    saved_ssl_set = false;
+    keepalive_interval = 0;
+    keepalive_pending = false;
+    last_activity = 0;
+    stream_loads = 0;
+#ifndef MYSQL_NON_THREADSAFE
+    coalesce_inflight = NULL;
+    lookup_pending = NULL;
+    ev_timer_init(&keepalive_timer, KeepaliveTimer, 0, 0);
+    keepalive_timer.data = this;
+    ev_timer_init(&lookup_timer, LookupTimer, 0, 0);
+    lookup_timer.data = this;
+#endif
     pthread_mutex_init(&query_lock, NULL);
 }
 
 MysqlConnection::~MysqlConnection() {
+#ifndef MYSQL_NON_THREADSAFE
+    if (keepalive_interval) {
+        ev_ref(EV_DEFAULT_UC);
+        ev_timer_stop(EV_DEFAULT_UC, &keepalive_timer);
+    }
+#endif
     this->Close();
+    free(connect_error);
     pthread_mutex_destroy(&query_lock);
 }
 
@@ -294,13 +556,442 @@ Handle<Value> MysqlConnection::AutoCommitSync(const Arguments& args) {
 
     REQ_BOOL_ARG(0, autocomit)
 
+    // Server reports autocommit mode in status of every reply
+    if (((conn->_conn->server_status & SERVER_STATUS_AUTOCOMMIT) != 0) ==
+        autocomit) {
+        conn->saved_autocommit = autocomit;
+        return scope.Close(True());
+    }
+
     if (mysql_autocommit(conn->_conn, autocomit)) {
         return scope.Close(False());
     }
 
+    conn->saved_autocommit = autocomit;
+
     return scope.Close(True());
 }
 
+/**
+ * EIO wrapper functions for MysqlConnection::BulkInsert
+ */
+#ifndef MYSQL_NON_THREADSAFE
+#define BULKINSERT_CELL_NULL 'N'
+#define BULKINSERT_CELL_LITERAL 'L'
+#define BULKINSERT_CELL_STRING 'S'
+// Comma and quoted escaped value, or comma and NULL
+#define BULKINSERT_CELL_MAX_LENGTH(length) \
+    (2*(length) + 3 > 5 ? 2*(length) + 3 : 5)
+
+/**
+ * Writes backtick-quoted identifier, dots separate database and table,
+ * "to" must hold 3*length + 2 bytes
+ *
+ * @ignore
+ */
+size_t MysqlConnection::QuoteIdentifier(char *to, const char *from,
+                                        size_t length) {
+    char *start = to;
+
+    *to++ = '`';
+    for (size_t i = 0; i < length; i++) {
+        if (from[i] == '.') {
+            *to++ = '`';
+            *to++ = '.';
+            *to++ = '`';
+        } else if (from[i] == '`') {
+            *to++ = '`';
+            *to++ = '`';
+        } else {
+            *to++ = from[i];
+        }
+    }
+    *to++ = '`';
+
+    return to - start;
+}
+
+int MysqlConnection::EIO_After_BulkInsert(eio_req *req) {
+    ev_unref(EV_DEFAULT_UC);
+    HandleScope scope;
+    struct bulkInsert_request *bulk_req =
+        reinterpret_cast<struct bulkInsert_request *>(req->data);
+
+    int argc = 2;
+    Local<Value> argv[2];
+
+    if (req->result) {
+        Local<Object> js_error = V8EXC(bulk_req->error ?
+                            bulk_req->error : "Error on bulk insert")->ToObject();
+        js_error->Set(V8STR("statement"),
+                      Integer::NewFromUnsigned(bulk_req->statements_count));
+        argv[0] = js_error;
+    } else {
+        argv[0] = Local<Value>::New(Null());
+    }
+    // Rows inserted by previous statements are reported even on error
+    argv[1] = Number::New(static_cast<double>(bulk_req->affected_rows));
+
+    TryCatch try_catch;
+
+    bulk_req->callback->Call(Context::GetCurrent()->Global(), argc, argv);
+
+    if (try_catch.HasCaught()) {
+        node::FatalException(try_catch);
+    }
+
+    bulk_req->callback.Dispose();
+    bulk_req->conn->Unref();
+    free(bulk_req->prefix);
+    free(bulk_req->cells);
+    free(bulk_req->cell_offsets);
+    free(bulk_req->cell_lengths);
+    free(bulk_req->cell_types);
+    free(bulk_req->error);
+    free(bulk_req);
+
+    return 0;
+}
+
+int MysqlConnection::EIO_BulkInsert(eio_req *req) {
+    struct bulkInsert_request *bulk_req =
+        reinterpret_cast<struct bulkInsert_request *>(req->data);
+    MysqlConnection *conn = bulk_req->conn;
+
+    req->result = 0;
+
+    if (!conn->_conn) {
+        req->result = 1;
+        return 0;
+    }
+
+    pthread_mutex_lock(&conn->query_lock);
+
+    MYSQLSYNC_DISABLE_MQ;
+
+    if (!conn->max_allowed_packet) {
+        MYSQL_RES *my_result = NULL;
+        MYSQL_ROW my_row;
+
+        if (!mysql_query(conn->_conn, "SELECT @@max_allowed_packet") &&
+            (my_result = mysql_store_result(conn->_conn)) &&
+            (my_row = mysql_fetch_row(my_result)) && my_row[0]) {
+            conn->max_allowed_packet = strtoul(my_row[0], NULL, 10);
+        }
+        if (my_result) {
+            mysql_free_result(my_result);
+        }
+        if (!conn->max_allowed_packet) {
+            // Server default for old versions
+            conn->max_allowed_packet = 1024*1024;
+        }
+    }
+
+    // Leave some space for packet header
+    size_t packet_limit = conn->max_allowed_packet > 1024 ?
+                          conn->max_allowed_packet - 1024 :
+                          conn->max_allowed_packet;
+
+    int escape_mode = conn->EscapeMode();
+
+    // Statement buffer must fit at least one row in the worst case
+    size_t max_row_length = 0;
+    size_t cell = 0;
+    for (uint32_t i = 0; i < bulk_req->rows_count; i++) {
+        size_t row_length = 3;
+        for (uint32_t j = 0; j < bulk_req->columns_count; j++, cell++) {
+            row_length +=
+                BULKINSERT_CELL_MAX_LENGTH(bulk_req->cell_lengths[cell]);
+        }
+        if (row_length > max_row_length) {
+            max_row_length = row_length;
+        }
+    }
+
+    size_t buffer_size = bulk_req->prefix_length + max_row_length;
+    if (buffer_size < packet_limit) {
+        buffer_size = packet_limit;
+    }
+
+    char *query = reinterpret_cast<char *>(malloc(buffer_size + 1));
+    if (!query) {
+        req->result = 1;
+        bulk_req->error = strdup("Could not allocate enough memory");
+        pthread_mutex_unlock(&conn->query_lock);
+        return 0;
+    }
+
+    memcpy(query, bulk_req->prefix, bulk_req->prefix_length);
+    size_t query_length = bulk_req->prefix_length;
+    uint32_t statement_rows = 0;
+
+    cell = 0;
+    for (uint32_t i = 0; i <= bulk_req->rows_count; i++) {
+        size_t row_length = 3;
+        if (i < bulk_req->rows_count) {
+            for (uint32_t j = 0; j < bulk_req->columns_count; j++) {
+                row_length += BULKINSERT_CELL_MAX_LENGTH(
+                    bulk_req->cell_lengths[cell + j]);
+            }
+        }
+
+        // Send statement when next row may not fit or rows are over
+        if (statement_rows &&
+            (i == bulk_req->rows_count ||
+             query_length + row_length > packet_limit)) {
+            if (mysql_real_query(conn->_conn, query, query_length)) {
+                req->result = 1;
+                bulk_req->error = strdup(mysql_error(conn->_conn));
+                break;
+            }
+            bulk_req->affected_rows += mysql_affected_rows(conn->_conn);
+            bulk_req->statements_count++;
+
+            query_length = bulk_req->prefix_length;
+            statement_rows = 0;
+        }
+
+        if (i == bulk_req->rows_count) {
+            break;
+        }
+
+        if (statement_rows) {
+            query[query_length++] = ',';
+        }
+        query[query_length++] = '(';
+        for (uint32_t j = 0; j < bulk_req->columns_count; j++, cell++) {
+            const char *value = bulk_req->cells + bulk_req->cell_offsets[cell];
+            size_t value_length = bulk_req->cell_lengths[cell];
+
+            if (j) {
+                query[query_length++] = ',';
+            }
+
+            switch (bulk_req->cell_types[cell]) {
+                case BULKINSERT_CELL_NULL:
+                    memcpy(query + query_length, "NULL", 4);
+                    query_length += 4;
+                    break;
+                case BULKINSERT_CELL_LITERAL:
+                    memcpy(query + query_length, value, value_length);
+                    query_length += value_length;
+                    break;
+                default:
+                    query[query_length++] = '\'';
+                    query_length += conn->Escape(query + query_length,
+                                                 value, value_length,
+                                                 escape_mode);
+                    query[query_length++] = '\'';
+                    break;
+            }
+        }
+        query[query_length++] = ')';
+        statement_rows++;
+    }
+
+    conn->last_activity = ev_time();
+    pthread_mutex_unlock(&conn->query_lock);
+
+    free(query);
+
+    return 0;
+}
+#endif
+
+/**
+ * Inserts rows into table using as few multi-row INSERT statements
+ * as max_allowed_packet allows, values are escaped in worker thread
+ *
+ * @param {String} table
+ * @param {Array} columns
+ * @param {Array} rows of arrays with values for each column
+ * @param {Function(error, affectedRows)} callback
+ */
+Handle<Value> MysqlConnection::BulkInsert(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    REQ_STR_ARG(0, table);
+    REQ_FUN_ARG(3, callback);
+
+    if (!args[1]->IsArray()) {
+        return THRTYPEEXC("Argument 1 must be an array");
+    }
+    if (!args[2]->IsArray()) {
+        return THRTYPEEXC("Argument 2 must be an array");
+    }
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    Local<Array> js_columns = Local<Array>::Cast(args[1]);
+    Local<Array> js_rows = Local<Array>::Cast(args[2]);
+    uint32_t columns_count = js_columns->Length();
+    uint32_t rows_count = js_rows->Length();
+
+    if (!columns_count) {
+        return THRTYPEEXC("Columns list must not be empty");
+    }
+
+    for (uint32_t i = 0; i < rows_count; i++) {
+        Local<Value> js_row = js_rows->Get(Integer::New(i));
+        if (!js_row->IsArray() ||
+            Local<Array>::Cast(js_row)->Length() != columns_count) {
+            return THRTYPEEXC("Each row must be an array of column values");
+        }
+    }
+
+    struct bulkInsert_request *bulk_req =
+        reinterpret_cast<struct bulkInsert_request *>(
+            calloc(1, sizeof(struct bulkInsert_request)));
+
+    if (!bulk_req) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    // Build statement prefix with quoted identifiers
+    size_t prefix_size = sizeof("INSERT INTO  () VALUES ") +
+                         3*table.length() + 2;
+    for (uint32_t i = 0; i < columns_count; i++) {
+        prefix_size += 3*js_columns->Get(Integer::New(i))->
+                                ToString()->Utf8Length() + 3;
+    }
+    bulk_req->prefix = reinterpret_cast<char *>(malloc(prefix_size));
+
+    uint32_t cells_count = columns_count*rows_count;
+    bulk_req->cell_offsets = reinterpret_cast<size_t *>(
+        calloc(cells_count + 1, sizeof(size_t)));
+    bulk_req->cell_lengths = reinterpret_cast<size_t *>(
+        calloc(cells_count + 1, sizeof(size_t)));
+    bulk_req->cell_types = reinterpret_cast<char *>(
+        calloc(cells_count + 1, sizeof(char)));
+
+    if (!bulk_req->prefix || !bulk_req->cell_offsets ||
+        !bulk_req->cell_lengths || !bulk_req->cell_types) {
+        free(bulk_req->prefix);
+        free(bulk_req->cell_offsets);
+        free(bulk_req->cell_lengths);
+        free(bulk_req->cell_types);
+        free(bulk_req);
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    char *prefix = bulk_req->prefix;
+    memcpy(prefix, "INSERT INTO ", 12);
+    prefix += 12;
+    prefix += QuoteIdentifier(prefix, *table, table.length());
+    *prefix++ = ' ';
+    *prefix++ = '(';
+    for (uint32_t i = 0; i < columns_count; i++) {
+        String::Utf8Value column(js_columns->Get(Integer::New(i))->ToString());
+        if (i) {
+            *prefix++ = ',';
+        }
+        prefix += QuoteIdentifier(prefix, *column, column.length());
+    }
+    memcpy(prefix, ") VALUES ", 9);
+    prefix += 9;
+    bulk_req->prefix_length = prefix - bulk_req->prefix;
+
+    // Copy raw values into one arena
+    size_t cells_size = 0;
+    size_t cells_capacity = 0;
+    uint32_t cell = 0;
+
+    for (uint32_t i = 0; i < rows_count; i++) {
+        Local<Array> js_row = Local<Array>::Cast(js_rows->Get(Integer::New(i)));
+
+        for (uint32_t j = 0; j < columns_count; j++, cell++) {
+            Local<Value> js_value = js_row->Get(Integer::New(j));
+            String::Utf8Value *str = NULL;
+            const char *data = NULL;
+            size_t length = 0;
+
+            if (js_value->IsNull() || js_value->IsUndefined()) {
+                bulk_req->cell_types[cell] = BULKINSERT_CELL_NULL;
+            } else if (js_value->IsBoolean()) {
+                bulk_req->cell_types[cell] = BULKINSERT_CELL_LITERAL;
+                data = js_value->IsTrue() ? "1" : "0";
+                length = 1;
+            } else if (js_value->IsNumber()) {
+                double number = js_value->NumberValue();
+                if (number != number || number - number != 0) {
+                    // NaN and Infinity have no SQL literal
+                    bulk_req->cell_types[cell] = BULKINSERT_CELL_NULL;
+                } else {
+                    bulk_req->cell_types[cell] = BULKINSERT_CELL_LITERAL;
+                    str = new String::Utf8Value(js_value->ToString());
+                }
+            } else if (node::Buffer::HasInstance(js_value)) {
+                bulk_req->cell_types[cell] = BULKINSERT_CELL_STRING;
+                data = node::Buffer::Data(js_value->ToObject());
+                length = node::Buffer::Length(js_value->ToObject());
+            } else {
+                bulk_req->cell_types[cell] = BULKINSERT_CELL_STRING;
+                str = new String::Utf8Value(js_value->ToString());
+            }
+
+            if (str) {
+                data = **str;
+                length = str->length();
+            }
+
+            if (cells_size + length > cells_capacity) {
+                size_t new_capacity = cells_capacity ?
+                                      2*cells_capacity : 64*1024;
+                while (new_capacity < cells_size + length) {
+                    new_capacity *= 2;
+                }
+                char *new_cells = reinterpret_cast<char *>(
+                    realloc(bulk_req->cells, new_capacity));
+                if (!new_cells) {
+                    delete str;
+                    free(bulk_req->prefix);
+                    free(bulk_req->cells);
+                    free(bulk_req->cell_offsets);
+                    free(bulk_req->cell_lengths);
+                    free(bulk_req->cell_types);
+                    free(bulk_req);
+                    V8::LowMemoryNotification();
+                    return THREXC("Could not allocate enough memory");
+                }
+                bulk_req->cells = new_cells;
+                cells_capacity = new_capacity;
+            }
+
+            if (length) {
+                memcpy(bulk_req->cells + cells_size, data, length);
+            }
+            bulk_req->cell_offsets[cell] = cells_size;
+            bulk_req->cell_lengths[cell] = length;
+            cells_size += length;
+
+            delete str;
+        }
+    }
+
+    bulk_req->callback = Persistent<Function>::New(callback);
+    bulk_req->conn = conn;
+    bulk_req->columns_count = columns_count;
+    bulk_req->rows_count = rows_count;
+
+    // Later identical reads must not attach to earlier ones
+    conn->coalesce_inflight = NULL;
+
+    MysqlScheduler::Submit(EIO_BulkInsert, EIO_After_BulkInsert,
+                           conn->priority, bulk_req);
+
+    ev_ref(EV_DEFAULT_UC);
+    conn->Ref();
+
+    return Undefined();
+#endif
+}
+
 /**
  * Changes the user and causes the database to become the default
  *
@@ -339,6 +1030,12 @@ Handle<Value> MysqlConnection::ChangeUserSync(const Arguments& args) {
         return scope.Close(False());
     }
 
+    SaveString(&conn->saved_user, *user);
+    SaveString(&conn->saved_password, args[1]->IsString() ? *password : NULL);
+    SaveString(&conn->saved_dbname, args[2]->IsString() ? *dbname : NULL);
+    conn->dbname_known = true;
+    conn->charset_known = true;
+
     return scope.Close(True());
 }
 
@@ -407,6 +1104,7 @@ int MysqlConnection::EIO_Connect(eio_req *req) {
     delete conn_req->hostname;
     delete conn_req->user;
     delete conn_req->password;
+    delete conn_req->dbname;
     delete conn_req->socket;
 
     return 0;
@@ -455,7 +1153,8 @@ Handle<Value> MysqlConnection::Connect(const Arguments& args) {
                               args[4]->IntegerValue() : 0;
     conn_req->socket = args.Length() > 6 && args[5]->IsString() ?
       new String::Utf8Value(args[5]->ToString()) : NULL;
-    eio_custom(EIO_Connect, EIO_PRI_DEFAULT, EIO_After_Connect, conn_req);
+    MysqlScheduler::Submit(EIO_Connect, EIO_After_Connect,
+                           conn->priority, conn_req);
 
     ev_ref(EV_DEFAULT_UC);
     conn->Ref();
@@ -622,43 +1321,266 @@ Handle<Value> MysqlConnection::ErrorSync(const Arguments& args) {
     return scope.Close(V8STR(error));
 }
 
+#define ESCAPE_MODE_LIBMYSQL 0
+#define ESCAPE_MODE_SINGLEBYTE 1
+#define ESCAPE_MODE_UTF8 2
+
 /**
- * Escapes special characters in a string for use in an SQL statement,
- * taking into account the current charset of the connection
+ * Chooses escaping routine for current connection charset
  *
- * @param {String} string
- * @return {String}
+ * @ignore
  */
-Handle<Value> MysqlConnection::EscapeSync(const Arguments& args) {
-    HandleScope scope;
-
-    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
-
-    MYSQLCONN_MUSTBE_CONNECTED;
-
-    REQ_STR_ARG(0, str)
-
-    int len = str.length();
-    char *result = new char[2*len + 1];
-    if (!result) {
-        V8::LowMemoryNotification();
-        return THREXC("Not enough memory");
+int MysqlConnection::EscapeMode() {
+    // Only quotes are doubled in this mode, leave it to libmysql
+    if (_conn->server_status & SERVER_STATUS_NO_BACKSLASH_ESCAPES) {
+        return ESCAPE_MODE_LIBMYSQL;
     }
 
-    mysql_real_escape_string(conn->_conn, result, *str, len);
-    Local<Value> js_result = V8STR(result);
+    const char *charset = mysql_character_set_name(_conn);
 
-    delete[] result;
+    if (!strcmp(charset, "latin1") || !strcmp(charset, "binary") ||
+        !strcmp(charset, "ascii")) {
+        return ESCAPE_MODE_SINGLEBYTE;
+    }
+    if (!strcmp(charset, "utf8") || !strcmp(charset, "utf8mb4")) {
+        return ESCAPE_MODE_UTF8;
+    }
 
-    return scope.Close(js_result);
+    return ESCAPE_MODE_LIBMYSQL;
 }
 
 /**
- * Returns the number of columns for the most recent query
+ * Escapes string like mysql_real_escape_string() does,
+ * to must have room for 2*length + 1 bytes
  *
- * @return {Integer}
+ * Clean blocks are copied 16 bytes at a time. In utf8 non-ASCII runs
+ * are passed to libmysql: they always end before an ASCII byte, which
+ * is a character boundary, so output stays byte-identical
+ *
+ * @ignore
  */
-Handle<Value> MysqlConnection::FieldCountSync(const Arguments& args) {
+unsigned long MysqlConnection::Escape(char *to, const char *from,  // NOLINT
+                                      unsigned long length, int mode) {  // NOLINT
+    if (mode == ESCAPE_MODE_LIBMYSQL) {
+        return mysql_real_escape_string(_conn, to, from, length);
+    }
+
+    const char *end = from + length;
+    char *to_start = to;
+
+    while (from < end) {
+#ifdef __SSE2__
+        if (end - from >= 16) {
+            __m128i block = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(from));
+            __m128i special = _mm_or_si128(
+                _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(0)),
+                                 _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\r')),
+                                 _mm_cmpeq_epi8(block, _mm_set1_epi8('\\')))),
+                _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\'')),
+                                 _mm_cmpeq_epi8(block, _mm_set1_epi8('"'))),
+                    _mm_cmpeq_epi8(block, _mm_set1_epi8('\032'))));
+            int mask = _mm_movemask_epi8(special);
+            if (mode == ESCAPE_MODE_UTF8) {
+                mask |= _mm_movemask_epi8(block);
+            }
+
+            if (!mask) {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(to), block);
+                from += 16;
+                to += 16;
+                continue;
+            }
+
+            // Copy clean prefix, special byte is handled below
+            int clean = __builtin_ctz(mask);
+            memcpy(to, from, clean);
+            from += clean;
+            to += clean;
+        }
+#endif
+        unsigned char c = *from;
+
+        if (c >= 0x80 && mode == ESCAPE_MODE_UTF8) {
+            const char *run_end = from + 1;
+            while (run_end < end && (unsigned char) *run_end >= 0x80) {
+                run_end++;
+            }
+            to += mysql_real_escape_string(_conn, to, from, run_end - from);
+            from = run_end;
+            continue;
+        }
+
+        char escape = 0;
+        switch (c) {
+            case 0:
+                escape = '0';
+                break;
+            case '\n':
+                escape = 'n';
+                break;
+            case '\r':
+                escape = 'r';
+                break;
+            case '\\':
+                escape = '\\';
+                break;
+            case '\'':
+                escape = '\'';
+                break;
+            case '"':
+                escape = '"';
+                break;
+            case '\032':
+                escape = 'Z';
+                break;
+        }
+
+        if (escape) {
+            *to++ = '\\';
+            *to++ = escape;
+        } else {
+            *to++ = c;
+        }
+        from++;
+    }
+
+    *to = 0;
+
+    return to - to_start;
+}
+
+/**
+ * Escapes special characters in a Buffer for use in an SQL statement,
+ * taking into account the current charset of the connection
+ *
+ * @param {Buffer} buffer
+ * @return {Buffer}
+ */
+Handle<Value> MysqlConnection::EscapeBuffer(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    if (args.Length() < 1 || !node::Buffer::HasInstance(args[0])) {
+        return THRTYPEEXC("Argument 0 must be a Buffer");
+    }
+
+    Local<Object> js_buffer = args[0]->ToObject();
+    size_t len = node::Buffer::Length(js_buffer);
+
+    char *result = reinterpret_cast<char *>(malloc(2*len + 1));
+    if (!result) {
+        V8::LowMemoryNotification();
+        return THREXC("Not enough memory");
+    }
+
+    unsigned long result_length = conn->Escape(result,  // NOLINT
+                                              node::Buffer::Data(js_buffer),
+                                              len, conn->EscapeMode());
+
+    node::Buffer *escaped = node::Buffer::New(result, result_length);
+
+    free(result);
+
+    return scope.Close(Local<Object>::New(escaped->handle_));
+}
+
+/**
+ * Escapes special characters in each string of array,
+ * taking into account the current charset of the connection
+ *
+ * @param {Array} strings
+ * @return {Array}
+ */
+Handle<Value> MysqlConnection::EscapeMany(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    if (args.Length() < 1 || !args[0]->IsArray()) {
+        return THRTYPEEXC("Argument 0 must be an array");
+    }
+
+    Local<Array> js_strings = Local<Array>::Cast(args[0]);
+    uint32_t count = js_strings->Length();
+    Local<Array> js_result = Array::New(count);
+
+    int mode = conn->EscapeMode();
+
+    // One scratch buffer grown to the longest value
+    char *result = NULL;
+    size_t result_size = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        String::Utf8Value str(js_strings->Get(Integer::New(i)));
+        size_t len = str.length();
+
+        if (2*len + 1 > result_size) {
+            char *grown = reinterpret_cast<char *>(realloc(result, 2*len + 1));
+            if (!grown) {
+                free(result);
+                V8::LowMemoryNotification();
+                return THREXC("Not enough memory");
+            }
+            result = grown;
+            result_size = 2*len + 1;
+        }
+
+        unsigned long result_length = conn->Escape(result, *str, len, mode);  // NOLINT
+        js_result->Set(Integer::New(i), String::New(result, result_length));
+    }
+
+    free(result);
+
+    return scope.Close(js_result);
+}
+
+/**
+ * Escapes special characters in a string for use in an SQL statement,
+ * taking into account the current charset of the connection
+ *
+ * @param {String} string
+ * @return {String}
+ */
+Handle<Value> MysqlConnection::EscapeSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    REQ_STR_ARG(0, str)
+
+    int len = str.length();
+    char *result = new char[2*len + 1];
+    if (!result) {
+        V8::LowMemoryNotification();
+        return THREXC("Not enough memory");
+    }
+
+    unsigned long result_length = conn->Escape(result, *str, len,  // NOLINT
+                                              conn->EscapeMode());
+    Local<Value> js_result = String::New(result, result_length);
+
+    delete[] result;
+
+    return scope.Close(js_result);
+}
+
+/**
+ * Returns the number of columns for the most recent query
+ *
+ * @return {Integer}
+ */
+Handle<Value> MysqlConnection::FieldCountSync(const Arguments& args) {
     HandleScope scope;
 
     MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
@@ -756,6 +1678,35 @@ Handle<Value> MysqlConnection::GetInfoStringSync(const Arguments& args) {
     return scope.Close(V8STR(info ? info : ""));
 }
 
+/**
+ * Converts SHOW WARNINGS result to array of warnings
+ *
+ * @ignore
+ */
+Local<Array> MysqlConnection::WarningsToArray(MYSQL_RES *result) {
+    HandleScope scope;
+
+    MYSQL_ROW row;
+    int i = 0;
+
+    Local<Array> js_result = Array::New();
+
+    while ((row = mysql_fetch_row(result))) {
+        // Each warning needs its own object
+        Local<Object> js_warning = Object::New();
+
+        js_warning->Set(V8STR("errno"), V8STR(row[1] ? row[1] : "0")->ToInteger());
+
+        js_warning->Set(V8STR("reason"), V8STR(row[2] ? row[2] : ""));
+
+        js_result->Set(Integer::New(i), js_warning);
+
+        i++;
+    }
+
+    return scope.Close(js_result);
+}
+
 /**
  * Gets result of SHOW WARNINGS
  *
@@ -769,31 +1720,19 @@ Handle<Value> MysqlConnection::GetWarningsSync(const Arguments& args) {
     MYSQLCONN_MUSTBE_CONNECTED;
 
     MYSQL_RES *result;
-    MYSQL_ROW row;
-    int i = 0;
-
-    Local<Object> js_warning = Object::New();
-    Local<Array> js_result = Array::New();
 
     if (mysql_warning_count(conn->_conn)) {
-        if (mysql_real_query(conn->_conn, "SHOW WARNINGS", 13) == 0) {
-            result = mysql_store_result(conn->_conn);
-
-            while ((row = mysql_fetch_row(result))) {
-                js_warning->Set(V8STR("errno"), V8STR(row[1])->ToInteger());
-
-                js_warning->Set(V8STR("reason"), V8STR(row[2]));
-
-                js_result->Set(Integer::New(i), js_warning);
-
-                i++;
-            }
+        if (mysql_real_query(conn->_conn, "SHOW WARNINGS", 13) == 0 &&
+            (result = mysql_store_result(conn->_conn))) {
+            Local<Array> js_result = WarningsToArray(result);
 
             mysql_free_result(result);
+
+            return scope.Close(js_result);
         }
     }
 
-    return scope.Close(js_result);
+    return scope.Close(Array::New());
 }
 
 /**
@@ -836,9 +1775,12 @@ Handle<Value> MysqlConnection::InitStatementSync(const Arguments& args) {
         return scope.Close(False());
     }
 
-    Local<Value> arg = External::New(my_statement);
+    int argc = 2;
+    Local<Value> argv[2];
+    argv[0] = External::New(my_statement);
+    argv[1] = Local<Value>::New(args.This());
     Persistent<Object> js_result(MysqlStatement::constructor_template->
-                             GetFunction()->NewInstance(1, &arg));
+                             GetFunction()->NewInstance(argc, argv));
 
     return scope.Close(js_result);
 }
@@ -855,149 +1797,1425 @@ Handle<Value> MysqlConnection::LastInsertIdSync(const Arguments& args) {
 
     MYSQLCONN_MUSTBE_CONNECTED;
 
-    MYSQL_RES *result;
-    my_ulonglong insert_id = 0;
-
-    if ( (result = mysql_store_result(conn->_conn)) == 0 &&
-         mysql_field_count(conn->_conn) == 0 &&
-         mysql_insert_id(conn->_conn) != 0) {
-        insert_id = mysql_insert_id(conn->_conn);
-    }
+    // Must not touch pending result set, mysql_insert_id() is enough
+    my_ulonglong insert_id = mysql_insert_id(conn->_conn);
 
-    return scope.Close(Integer::New(insert_id));
+    return scope.Close(Number::New(static_cast<double>(insert_id)));
 }
 
 /**
- * Checks if there are any more query results from a multi query
- *
- * @return {Boolean}
+ * EIO wrapper functions for MysqlConnection::LoadData
  */
-Handle<Value> MysqlConnection::MultiMoreResultsSync(const Arguments& args) {
-    HandleScope scope;
+#ifndef MYSQL_NON_THREADSAFE
+int MysqlConnection::LoadDataInfileInit(void **ptr, const char *filename,
+                                        void *userdata) {
+    // File name from query is ignored, data comes from loadData() source
+    *ptr = userdata;
+    return 0;
+}
 
-    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+int MysqlConnection::LoadDataInfileRead(void *ptr, char *buf,
+                                        unsigned int buf_len) {
+    struct loadData_request *load_req =
+        reinterpret_cast<struct loadData_request *>(ptr);
+    int r = 0;
+
+    if (load_req->source_data) {
+        r = load_req->source_length < buf_len ?
+            load_req->source_length : buf_len;
+        memcpy(buf, load_req->source_data, r);
+        load_req->source_data += r;
+        load_req->source_length -= r;
+        return r;
+    }
 
-    MYSQLCONN_MUSTBE_CONNECTED;
+    pthread_mutex_lock(&load_req->lock);
+    while (!load_req->ring_used && !load_req->ended && !load_req->aborted) {
+        pthread_cond_wait(&load_req->cond, &load_req->lock);
+    }
 
-    if (mysql_more_results(conn->_conn)) {
-        return scope.Close(True());
+    if (load_req->aborted) {
+        r = -1;
+    } else {
+        size_t length = load_req->ring_used < buf_len ?
+                        load_req->ring_used : buf_len;
+        size_t tail = load_req->ring_size - load_req->ring_start;
+        if (length > tail) {
+            memcpy(buf, load_req->ring + load_req->ring_start, tail);
+            memcpy(buf + tail, load_req->ring, length - tail);
+        } else {
+            memcpy(buf, load_req->ring + load_req->ring_start, length);
+        }
+        load_req->ring_start = (load_req->ring_start + length) %
+                               load_req->ring_size;
+        load_req->ring_used -= length;
+        r = length;
     }
+    pthread_mutex_unlock(&load_req->lock);
 
-    return scope.Close(False());
+    // Wake up main thread to refill ring buffer from pending chunks
+    if (r > 0) {
+        ev_async_send(EV_DEFAULT_UC, &load_req->drained_watcher);
+    }
+
+    return r;
+}
+
+void MysqlConnection::LoadDataInfileEnd(void *ptr) {
+    // Everything is freed in EIO_After_LoadData
+}
+
+int MysqlConnection::LoadDataInfileError(void *ptr, char *error_msg,
+                                         unsigned int error_msg_len) {
+    snprintf(error_msg, error_msg_len, "%s", "Error reading loadData source");
+    return CR_UNKNOWN_ERROR;
 }
 
 /**
- * Prepare next result from multi_query
+ * Copies pending stream chunks into ring buffer, must be called
+ * in main thread with request lock held
  *
- * @return {Boolean}
+ * @ignore
  */
-Handle<Value> MysqlConnection::MultiNextResultSync(const Arguments& args) {
-    HandleScope scope;
+void MysqlConnection::LoadDataFlushPending(
+                                struct loadData_request *load_req) {
+    uint32_t flushed = 0;
+    uint32_t pending_count = load_req->js_pending->Length();
+
+    while (flushed < pending_count &&
+           load_req->ring_used < load_req->ring_size) {
+        Local<Value> js_chunk =
+            load_req->js_pending->Get(Integer::New(flushed));
+        const char *data;
+        size_t length;
+        String::Utf8Value *str = NULL;
+
+        if (node::Buffer::HasInstance(js_chunk)) {
+            data = node::Buffer::Data(js_chunk->ToObject());
+            length = node::Buffer::Length(js_chunk->ToObject());
+        } else {
+            str = new String::Utf8Value(js_chunk->ToString());
+            data = **str;
+            length = str->length();
+        }
 
-    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+        data += load_req->pending_offset;
+        length -= load_req->pending_offset;
+
+        while (length && load_req->ring_used < load_req->ring_size) {
+            size_t end = (load_req->ring_start + load_req->ring_used) %
+                         load_req->ring_size;
+            size_t space = end < load_req->ring_start ?
+                           load_req->ring_start - end :
+                           load_req->ring_size - end;
+            if (space > length) {
+                space = length;
+            }
+            memcpy(load_req->ring + end, data, space);
+            load_req->ring_used += space;
+            load_req->pending_offset += space;
+            data += space;
+            length -= space;
+        }
 
-    MYSQLCONN_MUSTBE_CONNECTED;
+        delete str;
 
-    if (!mysql_more_results(conn->_conn)) {
-        return THREXC("There is no next result set."
-                        "Please, call MultiMoreResultsSync() to check "
-                        "whether to call this function/method");
+        if (length) {
+            break;
+        }
+        load_req->pending_offset = 0;
+        flushed++;
     }
 
-    if (!mysql_next_result(conn->_conn)) {
-        return scope.Close(True());
+    if (flushed) {
+        Local<Array> js_pending = Array::New(pending_count - flushed);
+        for (uint32_t i = flushed; i < pending_count; i++) {
+            js_pending->Set(Integer::New(i - flushed),
+                            load_req->js_pending->Get(Integer::New(i)));
+        }
+        load_req->js_pending.Dispose();
+        load_req->js_pending = Persistent<Array>::New(js_pending);
     }
 
-    return scope.Close(False());
+    if (load_req->stream_ended && !load_req->js_pending->Length()) {
+        load_req->ended = true;
+    }
+
+    pthread_cond_signal(&load_req->cond);
 }
 
-/**
- * Performs a multi_query on the database
- *
- * @param {String} multi_query
- * @return {Boolean}
- */
-Handle<Value> MysqlConnection::MultiRealQuerySync(const Arguments& args) {
+void MysqlConnection::LoadDataDrained(EV_P_ ev_async *watcher, int revents) {
     HandleScope scope;
+    struct loadData_request *load_req =
+        reinterpret_cast<struct loadData_request *>(watcher->data);
 
-    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+    if (load_req->js_source.IsEmpty() || load_req->source_data) {
+        return;
+    }
 
-    REQ_STR_ARG(0, query)
+    pthread_mutex_lock(&load_req->lock);
+    LoadDataFlushPending(load_req);
+    bool resume = load_req->stream_paused &&
+                  !load_req->js_pending->Length();
+    if (resume) {
+        load_req->stream_paused = false;
+    }
+    pthread_mutex_unlock(&load_req->lock);
 
-    MYSQLCONN_MUSTBE_CONNECTED;
+    // Stream may emit data synchronously, so call it without lock
+    if (resume) {
+        Local<Value> js_resume = load_req->js_source->Get(V8STR("resume"));
+        if (js_resume->IsFunction()) {
+            Local<Function>::Cast(js_resume)->Call(load_req->js_source, 0, NULL);
+        }
+    }
+}
 
-    MYSQLSYNC_ENABLE_MQ;
-    if (mysql_real_query(conn->_conn, *query, query.length()) != 0) {
-        MYSQLSYNC_DISABLE_MQ;
-        return scope.Close(False());
+Handle<Value> MysqlConnection::LoadDataOnData(const Arguments& args) {
+    HandleScope scope;
+    struct loadData_request *load_req =
+        reinterpret_cast<struct loadData_request *>(
+            Local<External>::Cast(args[0])->Value());
+
+    if (args.Length() < 2) {
+        return Undefined();
     }
-    MYSQLSYNC_DISABLE_MQ;
 
-    return scope.Close(True());
+    // Stream may reuse its Buffer for next chunk, keep own copy
+    Local<Value> js_chunk = args[1];
+    if (node::Buffer::HasInstance(js_chunk)) {
+        node::Buffer *chunk = node::Buffer::New(
+            node::Buffer::Data(js_chunk->ToObject()),
+            node::Buffer::Length(js_chunk->ToObject()));
+        js_chunk = Local<Value>::New(chunk->handle_);
+    }
+
+    pthread_mutex_lock(&load_req->lock);
+    load_req->js_pending->Set(Integer::New(load_req->js_pending->Length()),
+                              js_chunk);
+    LoadDataFlushPending(load_req);
+    bool pause = !load_req->stream_paused &&
+                 load_req->js_pending->Length();
+    if (pause) {
+        load_req->stream_paused = true;
+    }
+    pthread_mutex_unlock(&load_req->lock);
+
+    if (pause) {
+        Local<Value> js_pause = load_req->js_source->Get(V8STR("pause"));
+        if (js_pause->IsFunction()) {
+            Local<Function>::Cast(js_pause)->Call(load_req->js_source, 0, NULL);
+        }
+    }
+
+    return Undefined();
 }
 
-/**
- * Pings a server connection, or tries to reconnect if the connection has gone down
- *
- * @return {Boolean}
- */
-Handle<Value> MysqlConnection::PingSync(const Arguments& args) {
+Handle<Value> MysqlConnection::LoadDataOnEnd(const Arguments& args) {
     HandleScope scope;
+    struct loadData_request *load_req =
+        reinterpret_cast<struct loadData_request *>(
+            Local<External>::Cast(args[0])->Value());
 
-    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+    pthread_mutex_lock(&load_req->lock);
+    load_req->stream_ended = true;
+    LoadDataFlushPending(load_req);
+    pthread_mutex_unlock(&load_req->lock);
 
-    MYSQLCONN_MUSTBE_CONNECTED;
+    return Undefined();
+}
 
-    if (mysql_ping(conn->_conn)) {
-        return scope.Close(False());
-    }
+Handle<Value> MysqlConnection::LoadDataOnError(const Arguments& args) {
+    HandleScope scope;
+    struct loadData_request *load_req =
+        reinterpret_cast<struct loadData_request *>(
+            Local<External>::Cast(args[0])->Value());
 
-    return scope.Close(True());
+    pthread_mutex_lock(&load_req->lock);
+    load_req->aborted = true;
+    pthread_cond_signal(&load_req->cond);
+    pthread_mutex_unlock(&load_req->lock);
+
+    return Undefined();
 }
 
-/**
- * EIO wrapper functions for MysqlConnection::Query
- */
-#ifndef MYSQL_NON_THREADSAFE
-int MysqlConnection::EIO_After_Query(eio_req *req) {
+int MysqlConnection::EIO_After_LoadData(eio_req *req) {
     ev_unref(EV_DEFAULT_UC);
     HandleScope scope;
-    struct query_request *query_req = (struct query_request *)(req->data);
+    struct loadData_request *load_req =
+        reinterpret_cast<struct loadData_request *>(req->data);
+
+    // Stop listening to the stream before request is freed
+    if (!load_req->on_data.IsEmpty()) {
+        Local<Value> js_remove =
+            load_req->js_source->Get(V8STR("removeListener"));
+        if (js_remove->IsFunction()) {
+            Local<Value> argv[2];
+            argv[0] = V8STR("data");
+            argv[1] = Local<Value>::New(load_req->on_data);
+            Local<Function>::Cast(js_remove)->Call(load_req->js_source, 2, argv);
+            argv[0] = V8STR("end");
+            argv[1] = Local<Value>::New(load_req->on_end);
+            Local<Function>::Cast(js_remove)->Call(load_req->js_source, 2, argv);
+            argv[0] = V8STR("error");
+            argv[1] = Local<Value>::New(load_req->on_error);
+            Local<Function>::Cast(js_remove)->Call(load_req->js_source, 2, argv);
+        }
+        if (load_req->stream_paused) {
+            Local<Value> js_resume = load_req->js_source->Get(V8STR("resume"));
+            if (js_resume->IsFunction()) {
+                Local<Function>::Cast(js_resume)->Call(load_req->js_source,
+                                                       0, NULL);
+            }
+        }
+        load_req->on_data.Dispose();
+        load_req->on_end.Dispose();
+        load_req->on_error.Dispose();
+        load_req->conn->stream_loads--;
+    }
+
+    ev_ref(EV_DEFAULT_UC);
+    ev_async_stop(EV_DEFAULT_UC, &load_req->drained_watcher);
 
     int argc = 1;
     Local<Value> argv[2];
 
     if (req->result) {
-        argv[0] = V8EXC("Error on query execution");
+        argv[0] = V8EXC(load_req->error ?
+                        load_req->error : "Error on loading data");
     } else {
-        if (req->int1) {
-            argv[0] = External::New(query_req->my_result);
-            argv[1] = Integer::New(query_req->field_count);
-            Persistent<Object> js_result(MysqlResult::constructor_template->
-                                     GetFunction()->NewInstance(2, argv));
-
-            argv[1] = Local<Value>::New(scope.Close(js_result));
-            argc = 2;
-        }
         argv[0] = Local<Value>::New(Null());
+        argv[1] = Number::New(static_cast<double>(load_req->affected_rows));
+        argc = 2;
     }
 
     TryCatch try_catch;
 
-    query_req->callback->Call(Context::GetCurrent()->Global(), argc, argv);
+    load_req->callback->Call(Context::GetCurrent()->Global(), argc, argv);
 
     if (try_catch.HasCaught()) {
         node::FatalException(try_catch);
     }
 
-    query_req->callback.Dispose();
+    load_req->callback.Dispose();
+    load_req->js_source.Dispose();
+    load_req->js_pending.Dispose();
+    load_req->conn->Unref();
+    pthread_cond_destroy(&load_req->cond);
+    pthread_mutex_destroy(&load_req->lock);
+    delete load_req->query;
+    free(load_req->source_copy);
+    free(load_req->ring);
+    free(load_req->error);
+    free(load_req);
+
+    return 0;
+}
+
+int MysqlConnection::EIO_LoadData(eio_req *req) {
+    struct loadData_request *load_req =
+        reinterpret_cast<struct loadData_request *>(req->data);
+    MysqlConnection *conn = load_req->conn;
+
+    req->result = 0;
+
+    if (!conn->_conn) {
+        req->result = 1;
+        return 0;
+    }
+
+    pthread_mutex_lock(&conn->query_lock);
+
+    MYSQLSYNC_DISABLE_MQ;
+
+    mysql_set_local_infile_handler(conn->_conn,
+                                   LoadDataInfileInit,
+                                   LoadDataInfileRead,
+                                   LoadDataInfileEnd,
+                                   LoadDataInfileError,
+                                   load_req);
+    if (mysql_real_query(conn->_conn, **load_req->query,
+                         load_req->query->length())) {
+        req->result = 1;
+        load_req->error = strdup(mysql_error(conn->_conn));
+    } else {
+        load_req->affected_rows = mysql_affected_rows(conn->_conn);
+    }
+    mysql_set_local_infile_default(conn->_conn);
+    conn->last_activity = ev_time();
+    pthread_mutex_unlock(&conn->query_lock);
+
+    return 0;
+}
+#endif
+
+/**
+ * Performs LOAD DATA LOCAL INFILE query with data from a Buffer
+ * or a readable stream instead of a file, MYSQL_OPT_LOCAL_INFILE option
+ * must be enabled. Stream is paused while the ring buffer is full.
+ * Until stream load is done querySync(), realQuerySync() and
+ * bindParamSync() of its statements throw, they would wait for it
+ * and the stream would never be read
+ *
+ * @param {String} query
+ * @param {Buffer|Stream} source
+ * @param {Function(error, affectedRows)} callback
+ */
+Handle<Value> MysqlConnection::LoadData(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    REQ_STR_ARG(0, query);
+    REQ_FUN_ARG(2, callback);
+
+    if (!args[1]->IsObject()) {
+        return THRTYPEEXC("Argument 1 must be a Buffer or a stream");
+    }
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    Local<Object> js_source = args[1]->ToObject();
+    bool is_buffer = node::Buffer::HasInstance(js_source);
+
+    if (!is_buffer && !js_source->Get(V8STR("on"))->IsFunction()) {
+        return THRTYPEEXC("Argument 1 must be a Buffer or a stream");
+    }
+
+    struct loadData_request *load_req =
+        reinterpret_cast<struct loadData_request *>(
+            calloc(1, sizeof(struct loadData_request)));
+
+    if (!load_req) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    if (is_buffer) {
+        // Worker reads it while caller may write to the Buffer
+        size_t source_length = node::Buffer::Length(js_source);
+        load_req->source_copy = reinterpret_cast<char *>(
+            malloc(source_length ? source_length : 1));
+        if (!load_req->source_copy) {
+            free(load_req);
+            V8::LowMemoryNotification();
+            return THREXC("Could not allocate enough memory");
+        }
+        memcpy(load_req->source_copy, node::Buffer::Data(js_source),
+               source_length);
+    } else {
+        load_req->ring_size = 1024*1024;
+        load_req->ring = reinterpret_cast<char *>(
+            malloc(load_req->ring_size));
+        if (!load_req->ring) {
+            free(load_req);
+            V8::LowMemoryNotification();
+            return THREXC("Could not allocate enough memory");
+        }
+    }
+
+    pthread_mutex_init(&load_req->lock, NULL);
+    pthread_cond_init(&load_req->cond, NULL);
+
+    load_req->callback = Persistent<Function>::New(callback);
+    load_req->conn = conn;
+    load_req->query = new String::Utf8Value(args[0]->ToString());
+    load_req->js_source = Persistent<Object>::New(js_source);
+    load_req->js_pending = Persistent<Array>::New(Array::New());
+
+    ev_async_init(&load_req->drained_watcher, LoadDataDrained);
+    load_req->drained_watcher.data = load_req;
+    ev_async_start(EV_DEFAULT_UC, &load_req->drained_watcher);
+    ev_unref(EV_DEFAULT_UC);
+
+    if (is_buffer) {
+        load_req->source_data = load_req->source_copy;
+        load_req->source_length = node::Buffer::Length(js_source);
+        load_req->ended = true;
+    } else {
+        Local<Value> js_external = External::New(load_req);
+        load_req->on_data = Persistent<Function>::New(
+            MysqlScheduler::BindCallback(load_data_on_data, js_external));
+        load_req->on_end = Persistent<Function>::New(
+            MysqlScheduler::BindCallback(load_data_on_end, js_external));
+        load_req->on_error = Persistent<Function>::New(
+            MysqlScheduler::BindCallback(load_data_on_error, js_external));
+
+        Local<Function> js_on = Local<Function>::Cast(js_source->Get(V8STR("on")));
+        Local<Value> argv[2];
+        argv[0] = V8STR("data");
+        argv[1] = Local<Value>::New(load_req->on_data);
+        js_on->Call(js_source, 2, argv);
+        argv[0] = V8STR("end");
+        argv[1] = Local<Value>::New(load_req->on_end);
+        js_on->Call(js_source, 2, argv);
+        argv[0] = V8STR("error");
+        argv[1] = Local<Value>::New(load_req->on_error);
+        js_on->Call(js_source, 2, argv);
+
+        conn->stream_loads++;
+    }
+
+    // Later identical reads must not attach to earlier ones
+    conn->coalesce_inflight = NULL;
+
+    MysqlScheduler::Submit(EIO_LoadData, EIO_After_LoadData,
+                           conn->priority, load_req);
+
+    ev_ref(EV_DEFAULT_UC);
+    conn->Ref();
+
+    return Undefined();
+#endif
+}
+
+/**
+ * EIO wrapper functions for MysqlConnection::Lookup
+ */
+#ifndef MYSQL_NON_THREADSAFE
+uint32_t MysqlConnection::LookupHash(const char *key, size_t length) {
+    // FNV-1a
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(key[i]);
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+void MysqlConnection::LookupTimer(EV_P_ ev_timer *watcher, int revents) {
+    MysqlConnection *conn = reinterpret_cast<MysqlConnection *>(watcher->data);
+
+    struct lookup_request *lookup_req = conn->lookup_pending;
+    conn->lookup_pending = NULL;
+
+    while (lookup_req) {
+        struct lookup_request *next = lookup_req->next;
+        lookup_req->next = NULL;
+
+        MysqlScheduler::Submit(EIO_Lookup, EIO_After_Lookup,
+                               conn->priority, lookup_req);
+
+        ev_ref(EV_DEFAULT_UC);
+        conn->Ref();
+
+        lookup_req = next;
+    }
+
+    // Taken when batching started
+    conn->Unref();
+}
+
+void MysqlConnection::FreeLookup(struct lookup_request *lookup_req) {
+    for (uint32_t i = 0; i < lookup_req->callers_count; i++) {
+        lookup_req->callers[i].callback.Dispose();
+        free(lookup_req->callers[i].key);
+    }
+    if (lookup_req->my_result) {
+        mysql_free_result(lookup_req->my_result);
+    }
+    free(lookup_req->callers);
+    free(lookup_req->table);
+    free(lookup_req->key_column);
+    free(lookup_req->rows);
+    free(lookup_req->lengths);
+    free(lookup_req->first_row);
+    free(lookup_req->last_row);
+    free(lookup_req->next_row);
+    free(lookup_req->error);
+    free(lookup_req);
+}
+
+int MysqlConnection::EIO_After_Lookup(eio_req *req) {
+    ev_unref(EV_DEFAULT_UC);
+    HandleScope scope;
+    struct lookup_request *lookup_req =
+        reinterpret_cast<struct lookup_request *>(req->data);
+
+    int argc = 1;
+    Local<Value> argv[2];
+    Local<Array> js_keys_rows;
+
+    if (req->result) {
+        argv[0] = V8EXC(lookup_req->error ?
+                        lookup_req->error : "Error on lookup");
+    } else {
+        MYSQL_FIELD *fields = mysql_fetch_fields(lookup_req->my_result);
+
+        // Rows of each unique key, shared by callers with same key
+        js_keys_rows = Array::New(lookup_req->callers_count);
+
+        for (uint32_t i = 0; i < lookup_req->callers_count; i++) {
+            if (lookup_req->callers[i].unique_index != i) {
+                continue;
+            }
+
+            Local<Array> js_rows = Array::New();
+            uint32_t rows_count = 0;
+
+            for (int32_t row = lookup_req->first_row[i]; row >= 0;
+                 row = lookup_req->next_row[row]) {
+                Local<Object> js_row = Object::New();
+
+                for (uint32_t j = 0; j < lookup_req->fields_count; j++) {
+                    js_row->Set(V8STR(fields[j].name),
+                        MysqlResult::GetFieldValue(fields[j],
+                            lookup_req->rows[row][j],
+                            lookup_req->lengths[row*lookup_req->fields_count + j]));
+                }
+
+                js_rows->Set(Integer::New(rows_count++), js_row);
+            }
+
+            js_keys_rows->Set(Integer::New(i), js_rows);
+        }
+
+        argv[0] = Local<Value>::New(Null());
+        argc = 2;
+    }
+
+    for (uint32_t i = 0; i < lookup_req->callers_count; i++) {
+        if (argc == 2) {
+            argv[1] = js_keys_rows->Get(
+                Integer::New(lookup_req->callers[i].unique_index));
+        }
+
+        TryCatch try_catch;
+
+        lookup_req->callers[i].callback->Call(
+            Context::GetCurrent()->Global(), argc, argv);
+
+        if (try_catch.HasCaught()) {
+            node::FatalException(try_catch);
+        }
+    }
+
+    lookup_req->conn->Unref();
+    FreeLookup(lookup_req);
+
+    return 0;
+}
+
+int MysqlConnection::EIO_Lookup(eio_req *req) {
+    struct lookup_request *lookup_req =
+        reinterpret_cast<struct lookup_request *>(req->data);
+    MysqlConnection *conn = lookup_req->conn;
+    uint32_t callers_count = lookup_req->callers_count;
+
+    req->result = 0;
+
+    // Find callers with same key, table holds indexes of unique keys
+    uint32_t table_size = 16;
+    while (table_size < 2*callers_count) {
+        table_size *= 2;
+    }
+
+    int32_t *table = reinterpret_cast<int32_t *>(
+        malloc(table_size*sizeof(int32_t)));
+    lookup_req->first_row = reinterpret_cast<int32_t *>(
+        malloc(callers_count*sizeof(int32_t)));
+    lookup_req->last_row = reinterpret_cast<int32_t *>(
+        malloc(callers_count*sizeof(int32_t)));
+
+    size_t table_length = strlen(lookup_req->table);
+    size_t key_column_length = strlen(lookup_req->key_column);
+    size_t query_size = 3*table_length + 2 +
+                        3*key_column_length + 2 + 64;
+    for (uint32_t i = 0; i < callers_count; i++) {
+        query_size += 2*lookup_req->callers[i].key_length + 3;
+    }
+    char *query = reinterpret_cast<char *>(malloc(query_size));
+
+    if (!table || !lookup_req->first_row || !lookup_req->last_row || !query) {
+        free(table);
+        free(query);
+        req->result = 1;
+        lookup_req->error = strdup("Could not allocate enough memory");
+        return 0;
+    }
+
+    memset(table, -1, table_size*sizeof(int32_t));
+
+    pthread_mutex_lock(&conn->query_lock);
+
+    if (!conn->_conn) {
+        pthread_mutex_unlock(&conn->query_lock);
+        free(table);
+        free(query);
+        req->result = 1;
+        lookup_req->error = strdup("Not connected");
+        return 0;
+    }
+
+    int escape_mode = conn->EscapeMode();
+
+    size_t query_length = 0;
+
+    memcpy(query, "SELECT * FROM ", 14);
+    query_length += 14;
+    query_length += QuoteIdentifier(query + query_length,
+                                    lookup_req->table, table_length);
+    memcpy(query + query_length, " WHERE ", 7);
+    query_length += 7;
+    query_length += QuoteIdentifier(query + query_length,
+                                    lookup_req->key_column,
+                                    key_column_length);
+    memcpy(query + query_length, " IN (", 5);
+    query_length += 5;
+
+    for (uint32_t i = 0; i < callers_count; i++) {
+        struct lookup_caller *caller = &lookup_req->callers[i];
+        uint32_t slot = LookupHash(caller->key, caller->key_length) &
+                        (table_size - 1);
+
+        while (table[slot] >= 0) {
+            struct lookup_caller *other = &lookup_req->callers[table[slot]];
+            if (other->key_length == caller->key_length &&
+                !memcmp(other->key, caller->key, caller->key_length)) {
+                break;
+            }
+            slot = (slot + 1) & (table_size - 1);
+        }
+
+        if (table[slot] >= 0) {
+            caller->unique_index = table[slot];
+            continue;
+        }
+
+        table[slot] = i;
+        caller->unique_index = i;
+        lookup_req->first_row[i] = -1;
+        lookup_req->last_row[i] = -1;
+
+        if (query[query_length - 1] != '(') {
+            query[query_length++] = ',';
+        }
+        query[query_length++] = '\'';
+        query_length += conn->Escape(query + query_length, caller->key,
+                                     caller->key_length, escape_mode);
+        query[query_length++] = '\'';
+    }
+    query[query_length++] = ')';
+
+    if (conn->ExecuteQuery(query, query_length) ||
+        !(lookup_req->my_result = mysql_store_result(conn->_conn))) {
+        req->result = 1;
+        lookup_req->error = strdup(conn->_conn ? mysql_error(conn->_conn) :
+                                                 "Not connected");
+    }
+
+    conn->last_activity = ev_time();
+    pthread_mutex_unlock(&conn->query_lock);
+
+    free(query);
+
+    if (req->result) {
+        free(table);
+        return 0;
+    }
+
+    // Demultiplex rows by key column value
+    MYSQL_RES *my_result = lookup_req->my_result;
+    MYSQL_FIELD *fields = mysql_fetch_fields(my_result);
+    uint32_t fields_count = mysql_num_fields(my_result);
+    uint32_t rows_count = mysql_num_rows(my_result);
+    int32_t key_field = -1;
+
+    // Key column name may be qualified
+    const char *key_name = strrchr(lookup_req->key_column, '.');
+    key_name = key_name ? key_name + 1 : lookup_req->key_column;
+    for (uint32_t j = 0; j < fields_count; j++) {
+        if (!strcasecmp(fields[j].name, key_name)) {
+            key_field = j;
+            break;
+        }
+    }
+
+    lookup_req->fields_count = fields_count;
+    lookup_req->rows = reinterpret_cast<MYSQL_ROW *>(
+        malloc((rows_count + 1)*sizeof(MYSQL_ROW)));
+    lookup_req->lengths = reinterpret_cast<unsigned long *>(  // NOLINT
+        malloc((rows_count*fields_count + 1)*sizeof(unsigned long)));  // NOLINT
+    lookup_req->next_row = reinterpret_cast<int32_t *>(
+        malloc((rows_count + 1)*sizeof(int32_t)));
+
+    if (key_field < 0 || !lookup_req->rows || !lookup_req->lengths ||
+        !lookup_req->next_row) {
+        free(table);
+        req->result = 1;
+        lookup_req->error = strdup(key_field < 0 ?
+                                   "Key column is not in result" :
+                                   "Could not allocate enough memory");
+        return 0;
+    }
+
+    MYSQL_ROW row;
+    uint32_t row_index = 0;
+    while ((row = mysql_fetch_row(my_result)) && row_index < rows_count) {
+        unsigned long *lengths = mysql_fetch_lengths(my_result);  // NOLINT
+        lookup_req->rows[row_index] = row;
+        memcpy(lookup_req->lengths + row_index*fields_count, lengths,
+               fields_count*sizeof(unsigned long));  // NOLINT
+        lookup_req->next_row[row_index] = -1;
+
+        if (row[key_field]) {
+            uint32_t slot = LookupHash(row[key_field], lengths[key_field]) &
+                            (table_size - 1);
+            while (table[slot] >= 0) {
+                struct lookup_caller *caller = &lookup_req->callers[table[slot]];
+                if (caller->key_length == lengths[key_field] &&
+                    !memcmp(caller->key, row[key_field], caller->key_length)) {
+                    int32_t key = table[slot];
+                    if (lookup_req->last_row[key] >= 0) {
+                        lookup_req->next_row[lookup_req->last_row[key]] =
+                            row_index;
+                    } else {
+                        lookup_req->first_row[key] = row_index;
+                    }
+                    lookup_req->last_row[key] = row_index;
+                    break;
+                }
+                slot = (slot + 1) & (table_size - 1);
+            }
+        }
+
+        row_index++;
+    }
+    lookup_req->rows_count = row_index;
+
+    free(table);
+
+    return 0;
+}
+#endif
+
+/**
+ * Looks up rows by key, keys requested during one event loop tick
+ * on the same table and key column are fetched by one query with
+ * WHERE keyColumn IN (...). Rows are matched to keys by exact bytes
+ * of key column, column collation is not used. With case-insensitive
+ * or PAD SPACE collations a key like 'ABC' selects row with 'abc',
+ * but the row is dropped, so keys must be given as server stores them
+ *
+ * @param {String} table
+ * @param {String} keyColumn
+ * @param {String|Number} key
+ * @param {Function(error, rows)} callback
+ */
+Handle<Value> MysqlConnection::Lookup(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    REQ_STR_ARG(0, table);
+    REQ_STR_ARG(1, key_column);
+    if (args.Length() < 3 || (!args[2]->IsString() && !args[2]->IsNumber())) {
+        return THRTYPEEXC("Argument 2 must be a string or number");
+    }
+    REQ_FUN_ARG(3, callback);
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    String::Utf8Value key(args[2]->ToString());
+
+    struct lookup_request *lookup_req = conn->lookup_pending;
+    while (lookup_req && (strcmp(lookup_req->table, *table) ||
+                          strcmp(lookup_req->key_column, *key_column))) {
+        lookup_req = lookup_req->next;
+    }
+
+    if (!lookup_req) {
+        lookup_req = reinterpret_cast<struct lookup_request *>(
+            calloc(1, sizeof(struct lookup_request)));
+
+        if (!lookup_req) {
+            V8::LowMemoryNotification();
+            return THREXC("Could not allocate enough memory");
+        }
+
+        lookup_req->conn = conn;
+        lookup_req->table = strdup(*table);
+        lookup_req->key_column = strdup(*key_column);
+
+        if (!lookup_req->table || !lookup_req->key_column) {
+            FreeLookup(lookup_req);
+            V8::LowMemoryNotification();
+            return THREXC("Could not allocate enough memory");
+        }
+
+        if (!conn->lookup_pending) {
+            // Flush on next event loop iteration
+            ev_timer_set(&conn->lookup_timer, 0, 0);
+            ev_timer_start(EV_DEFAULT_UC, &conn->lookup_timer);
+            conn->Ref();
+        }
+
+        lookup_req->next = conn->lookup_pending;
+        conn->lookup_pending = lookup_req;
+    }
+
+    if (lookup_req->callers_count == lookup_req->callers_capacity) {
+        uint32_t capacity = lookup_req->callers_capacity ?
+                            2*lookup_req->callers_capacity : 16;
+        struct lookup_caller *callers = reinterpret_cast<struct lookup_caller *>(
+            realloc(lookup_req->callers, capacity*sizeof(struct lookup_caller)));
+
+        if (!callers) {
+            V8::LowMemoryNotification();
+            return THREXC("Could not allocate enough memory");
+        }
+
+        lookup_req->callers = callers;
+        lookup_req->callers_capacity = capacity;
+    }
+
+    struct lookup_caller *caller =
+        &lookup_req->callers[lookup_req->callers_count];
+
+    caller->key = reinterpret_cast<char *>(malloc(key.length() + 1));
+    if (!caller->key) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+    memcpy(caller->key, *key, key.length() + 1);
+    caller->key_length = key.length();
+    caller->callback = Persistent<Function>::New(callback);
+
+    lookup_req->callers_count++;
+
+    return Undefined();
+#endif
+}
+
+/**
+ * Checks if there are any more query results from a multi query
+ *
+ * @return {Boolean}
+ */
+Handle<Value> MysqlConnection::MultiMoreResultsSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    if (mysql_more_results(conn->_conn)) {
+        return scope.Close(True());
+    }
+
+    return scope.Close(False());
+}
+
+/**
+ * Prepare next result from multi_query
+ *
+ * @return {Boolean}
+ */
+Handle<Value> MysqlConnection::MultiNextResultSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    if (!mysql_more_results(conn->_conn)) {
+        return THREXC("There is no next result set."
+                        "Please, call MultiMoreResultsSync() to check "
+                        "whether to call this function/method");
+    }
+
+    if (!mysql_next_result(conn->_conn)) {
+        return scope.Close(True());
+    }
+
+    return scope.Close(False());
+}
+
+/**
+ * Performs a multi_query on the database
+ *
+ * @param {String} multi_query
+ * @return {Boolean}
+ */
+Handle<Value> MysqlConnection::MultiRealQuerySync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    REQ_STR_ARG(0, query)
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    // Multi statements stay enabled until next query switches them off,
+    // results of this query must be read first anyway
+    MYSQLSYNC_ENABLE_MQ;
+    conn->TrackSessionState(*query, query.length());
+    if (mysql_real_query(conn->_conn, *query, query.length()) != 0) {
+        return scope.Close(False());
+    }
+
+    return scope.Close(True());
+}
+
+/**
+ * EIO wrapper functions for MysqlConnection::Ping
+ */
+#ifndef MYSQL_NON_THREADSAFE
+int MysqlConnection::EIO_After_Ping(eio_req *req) {
+    HandleScope scope;
+    struct ping_request *ping_req =
+        reinterpret_cast<struct ping_request *>(req->data);
+    MysqlConnection *conn = ping_req->conn;
+
+    Local<Value> argv[2];
+
+    if (req->result) {
+        argv[0] = V8EXC(ping_req->error ? ping_req->error : "Error on ping");
+    } else {
+        argv[0] = Local<Value>::New(Null());
+    }
+    argv[1] = Number::New(ping_req->rtt);
+
+    TryCatch try_catch;
+
+    if (ping_req->keepalive) {
+        // Keepalive jobs don't hold event loop
+        conn->keepalive_pending = false;
+        if (!ping_req->skipped) {
+            conn->Emit(V8STR("keepalive"), 2, argv);
+        }
+    } else {
+        ev_unref(EV_DEFAULT_UC);
+        ping_req->callback->Call(Context::GetCurrent()->Global(), 2, argv);
+        ping_req->callback.Dispose();
+    }
+
+    if (try_catch.HasCaught()) {
+        node::FatalException(try_catch);
+    }
+
+    conn->Unref();
+    free(ping_req->error);
+    free(ping_req);
+
+    return 0;
+}
+
+int MysqlConnection::EIO_Ping(eio_req *req) {
+    struct ping_request *ping_req =
+        reinterpret_cast<struct ping_request *>(req->data);
+    MysqlConnection *conn = ping_req->conn;
+
+    req->result = 0;
+
+    if (ping_req->keepalive) {
+        // Connection used by other job right now is alive
+        if (pthread_mutex_trylock(&conn->query_lock)) {
+            ping_req->skipped = true;
+            return 0;
+        }
+        if (!conn->_conn ||
+            ev_time() - conn->last_activity < conn->keepalive_interval) {
+            ping_req->skipped = true;
+            pthread_mutex_unlock(&conn->query_lock);
+            return 0;
+        }
+    } else {
+        pthread_mutex_lock(&conn->query_lock);
+    }
+
+    if (!conn->_conn) {
+        req->result = 1;
+        ping_req->error = strdup("Not connected");
+        pthread_mutex_unlock(&conn->query_lock);
+        return 0;
+    }
+
+    ev_tstamp start = ev_time();
+    int r = mysql_ping(conn->_conn);
+
+    if (r && conn->reconnect && conn->Reconnect()) {
+        // Dead connection is replaced, measure new one
+        ping_req->reconnected = true;
+        start = ev_time();
+        r = mysql_ping(conn->_conn);
+    }
+
+    ping_req->rtt = (ev_time() - start)*1000;
+
+    if (r) {
+        req->result = 1;
+        ping_req->error = strdup(mysql_error(conn->_conn));
+        // Dead connection is reported by connectedSync()
+        conn->connected = false;
+    } else {
+        conn->connected = true;
+    }
+
+    conn->last_activity = ev_time();
+    pthread_mutex_unlock(&conn->query_lock);
+
+    return 0;
+}
+
+void MysqlConnection::KeepaliveTimer(EV_P_ ev_timer *watcher, int revents) {
+    MysqlConnection *conn = reinterpret_cast<MysqlConnection *>(watcher->data);
+
+    if (conn->keepalive_pending || !conn->_conn) {
+        return;
+    }
+
+    struct ping_request *ping_req =
+        reinterpret_cast<struct ping_request *>(
+            calloc(1, sizeof(struct ping_request)));
+
+    if (!ping_req) {
+        return;
+    }
+
+    ping_req->conn = conn;
+    ping_req->keepalive = true;
+    conn->keepalive_pending = true;
+
+    MysqlScheduler::Submit(EIO_Ping, EIO_After_Ping, conn->priority, ping_req);
+
+    conn->Ref();
+}
+#endif
+
+/**
+ * Pings a server connection in worker thread, reconnects if connection
+ * has gone down and reconnect is enabled by setReconnectSync()
+ *
+ * @param {Function(error, rtt)} callback, rtt is round trip time in ms
+ */
+Handle<Value> MysqlConnection::Ping(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    REQ_FUN_ARG(0, callback);
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    struct ping_request *ping_req =
+        reinterpret_cast<struct ping_request *>(
+            calloc(1, sizeof(struct ping_request)));
+
+    if (!ping_req) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    ping_req->callback = Persistent<Function>::New(callback);
+    ping_req->conn = conn;
+
+    MysqlScheduler::Submit(EIO_Ping, EIO_After_Ping, conn->priority, ping_req);
+
+    ev_ref(EV_DEFAULT_UC);
+    conn->Ref();
+
+    return Undefined();
+#endif
+}
+
+/**
+ * Pings a server connection, or tries to reconnect if the connection has gone down
+ *
+ * @return {Boolean}
+ */
+Handle<Value> MysqlConnection::PingSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    if (mysql_ping(conn->_conn)) {
+        return scope.Close(False());
+    }
+
+    return scope.Close(True());
+}
+
+/**
+ * Marks tracked database and charset as unknown when query
+ * could change them
+ *
+ * @ignore
+ */
+void MysqlConnection::TrackSessionState(const char *query, size_t length) {
+    const char *end = query + length;
+
+    while (query < end && isspace(*query)) {
+        query++;
+    }
+
+    if (multi_query) {
+        dbname_known = false;
+        charset_known = false;
+    } else if (end - query > 3 && !strncasecmp(query, "USE", 3) &&
+               isspace(query[3])) {
+        dbname_known = false;
+    } else if (end - query > 3 && !strncasecmp(query, "SET", 3) &&
+               isspace(query[3])) {
+        charset_known = false;
+    }
+}
+
+/**
+ * Sends query with multi statements off, lost connection is
+ * reestablished and idempotent query is repeated, caller must
+ * hold query_lock
+ *
+ * @ignore
+ */
+int MysqlConnection::ExecuteQuery(const char *query, size_t length) {
+    MysqlConnection *conn = this;
+
+    MYSQLSYNC_DISABLE_MQ;
+    TrackSessionState(query, length);
+
+    int r = mysql_real_query(_conn, query, length);
+    if (r != 0 && reconnect &&
+        (mysql_errno(_conn) == CR_SERVER_GONE_ERROR ||
+         mysql_errno(_conn) == CR_SERVER_LOST)) {
+        // Result of lost write or transaction is unknown, so only
+        // idempotent autocommitted queries are retried
+        bool retry = saved_autocommit != 0 &&
+                     IsIdempotentQuery(query, length);
+        if (Reconnect() && retry) {
+            r = mysql_real_query(_conn, query, length);
+        }
+    }
+
+    return r;
+}
+
+/**
+ * Checks if query only reads data, so it can be safely repeated
+ * after reconnect or sent to replica
+ *
+ * @ignore
+ */
+bool MysqlConnection::IsIdempotentQuery(const char *query, size_t length) {
+    static const char *readonly_commands[] = {
+        "SELECT", "SHOW", "DESCRIBE", "DESC", "EXPLAIN", NULL
+    };
+
+    const char *end = query + length;
+
+    while (query < end && (*query == ' ' || *query == '\t' ||
+           *query == '\n' || *query == '\r' || *query == '(')) {
+        query++;
+    }
+
+    for (int i = 0; readonly_commands[i]; i++) {
+        size_t command_length = strlen(readonly_commands[i]);
+        if (static_cast<size_t>(end - query) >= command_length &&
+            !strncasecmp(query, readonly_commands[i], command_length) &&
+            (static_cast<size_t>(end - query) == command_length ||
+             (!isalnum(query[command_length]) &&
+              query[command_length] != '_'))) {
+            break;
+        }
+        if (!readonly_commands[i + 1]) {
+            return false;
+        }
+    }
+
+    // SELECT ... FOR UPDATE, LOCK IN SHARE MODE and INTO have side effects
+    for (; query < end; query++) {
+        if ((end - query >= 10 && !strncasecmp(query, "FOR UPDATE", 10)) ||
+            (end - query >= 18 &&
+             !strncasecmp(query, "LOCK IN SHARE MODE", 18)) ||
+            (end - query >= 5 && !strncasecmp(query, "INTO ", 5))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * EIO wrapper functions for MysqlConnection::Query
+ */
+#ifndef MYSQL_NON_THREADSAFE
+int MysqlConnection::EIO_After_Query(eio_req *req) {
+    ev_unref(EV_DEFAULT_UC);
+    HandleScope scope;
+    struct query_request *query_req = (struct query_request *)(req->data);
+    MysqlConnection *conn = query_req->conn;
+
+    if (query_req->coalesce) {
+        // Same query issued from callbacks must go to server again
+        struct query_request **inflight = &conn->coalesce_inflight;
+        while (*inflight && *inflight != query_req) {
+            inflight = &(*inflight)->next_inflight;
+        }
+        if (*inflight) {
+            *inflight = query_req->next_inflight;
+        }
+    }
+
+    int argc = 1;
+    Local<Value> argv[3];
+    // Rows converted once for all coalesced callbacks
+    Local<Array> js_rows;
+
+    if (req->result) {
+        Local<Object> js_error = V8EXC(query_req->error ?
+                            query_req->error : "Error on query execution")->ToObject();
+        js_error->Set(V8STR("errno"), Integer::NewFromUnsigned(query_req->error_errno));
+        argv[0] = js_error;
+    } else {
+        if (req->int1 && query_req->coalesce) {
+            js_rows = MysqlResult::RowsToArray(query_req->my_result);
+            mysql_free_result(query_req->my_result);
+            argv[1] = js_rows;
+        } else if (req->int1) {
+            argv[0] = External::New(query_req->my_result);
+            argv[1] = Integer::New(query_req->field_count);
+            argv[2] = Integer::New(conn->priority);
+            Persistent<Object> js_result(MysqlResult::constructor_template->
+                                     GetFunction()->NewInstance(3, argv));
+
+            argv[1] = Local<Value>::New(scope.Close(js_result));
+        } else {
+            argv[1] = Local<Value>::New(Undefined());
+        }
+        argv[0] = Local<Value>::New(Null());
+
+        Local<Object> js_info = Object::New();
+        if (query_req->affected_rows == ((my_ulonglong)-1)) {
+            js_info->Set(V8STR("affectedRows"), Integer::New(-1));
+        } else {
+            js_info->Set(V8STR("affectedRows"),
+                Number::New(static_cast<double>(query_req->affected_rows)));
+        }
+        js_info->Set(V8STR("insertId"),
+            Number::New(static_cast<double>(query_req->insert_id)));
+        js_info->Set(V8STR("warningCount"),
+            Integer::NewFromUnsigned(query_req->warning_count));
+        if (query_req->info) {
+            js_info->Set(V8STR("info"), V8STR(query_req->info));
+        } else {
+            js_info->Set(V8STR("info"), Null());
+        }
+        if (query_req->fetch_warnings) {
+            if (query_req->warnings_result) {
+                js_info->Set(V8STR("warnings"),
+                    WarningsToArray(query_req->warnings_result));
+                mysql_free_result(query_req->warnings_result);
+            } else {
+                js_info->Set(V8STR("warnings"), Array::New());
+            }
+        }
+        argv[2] = js_info;
+        argc = 3;
+    }
+
+    TryCatch try_catch;
+
+    if (query_req->coalesce == QUERY_COALESCE_COPY && !js_rows.IsEmpty()) {
+        argv[1] = CopyRows(js_rows);
+    }
+    query_req->callback->Call(Context::GetCurrent()->Global(), argc, argv);
+
+    if (try_catch.HasCaught()) {
+        node::FatalException(try_catch);
+    }
+
+    struct query_waiter *waiter = query_req->waiters;
+    while (waiter) {
+        struct query_waiter *next = waiter->next;
+
+        if (!js_rows.IsEmpty()) {
+            if (waiter->coalesce == QUERY_COALESCE_COPY) {
+                argv[1] = CopyRows(js_rows);
+            } else {
+                argv[1] = js_rows;
+            }
+        }
+
+        TryCatch waiter_try_catch;
+
+        waiter->callback->Call(Context::GetCurrent()->Global(), argc, argv);
+
+        if (waiter_try_catch.HasCaught()) {
+            node::FatalException(waiter_try_catch);
+        }
+
+        waiter->callback.Dispose();
+        delete waiter;
+        waiter = next;
+    }
+
+    query_req->callback.Dispose();
     query_req->conn->Unref();
-    free(query_req->query);
+    if (query_req->query_buffer.IsEmpty()) {
+        free(query_req->query);
+    } else {
+        query_req->query_buffer.Dispose();
+    }
+    free(query_req->info);
+    free(query_req->error);
     free(query_req);
 
     return 0;
 }
 
+/**
+ * Copies rows of coalesced query, so callbacks can't see
+ * each other's changes
+ *
+ * @ignore
+ */
+Local<Array> MysqlConnection::CopyRows(Local<Array> js_rows) {
+    HandleScope scope;
+
+    uint32_t rows_count = js_rows->Length();
+    Local<Array> js_copy = Array::New(rows_count);
+
+    for (uint32_t i = 0; i < rows_count; i++) {
+        Local<Object> js_row = js_rows->Get(Integer::New(i))->ToObject();
+        Local<Array> js_names = js_row->GetPropertyNames();
+        Local<Object> js_row_copy = Object::New();
+
+        for (uint32_t j = 0; j < js_names->Length(); j++) {
+            Local<Value> js_name = js_names->Get(Integer::New(j));
+            Local<Value> js_value = js_row->Get(js_name);
+
+            // Strings, numbers and null are immutable
+            if (js_value->IsDate()) {
+                js_value = Date::New(js_value->NumberValue());
+            } else if (js_value->IsArray()) {
+                Local<Array> js_set = Local<Array>::Cast(js_value);
+                Local<Array> js_set_copy = Array::New(js_set->Length());
+                for (uint32_t k = 0; k < js_set->Length(); k++) {
+                    js_set_copy->Set(Integer::New(k),
+                                     js_set->Get(Integer::New(k)));
+                }
+                js_value = js_set_copy;
+            }
+
+            js_row_copy->Set(js_name, js_value);
+        }
+
+        js_copy->Set(Integer::New(i), js_row_copy);
+    }
+
+    return scope.Close(js_copy);
+}
+
 int MysqlConnection::EIO_Query(eio_req *req) {
     struct query_request *query_req = (struct query_request *)(req->data);
 
@@ -1008,13 +3226,16 @@ int MysqlConnection::EIO_Query(eio_req *req) {
         return 0;
     }
 
-    MYSQLSYNC_DISABLE_MQ;
-
     pthread_mutex_lock(&conn->query_lock);
-    int r = mysql_query(conn->_conn, query_req->query);
+
+    int r = conn->ExecuteQuery(query_req->query, query_req->query_length);
     if (r != 0) {
         // Query error
         req->result = 1;
+        if (conn->_conn) {
+            query_req->error_errno = mysql_errno(conn->_conn);
+            query_req->error = strdup(mysql_error(conn->_conn));
+        }
     } else {
         req->result = 0;
 
@@ -1034,7 +3255,22 @@ int MysqlConnection::EIO_Query(eio_req *req) {
             req->int1 = 1;
             query_req->my_result = my_result;
         }
+
+        query_req->affected_rows = mysql_affected_rows(conn->_conn);
+        query_req->insert_id = mysql_insert_id(conn->_conn);
+        query_req->warning_count = mysql_warning_count(conn->_conn);
+        const char *info = mysql_info(conn->_conn);
+        if (info) {
+            query_req->info = strdup(info);
+        }
+
+        // Saves separate blocking SHOW WARNINGS round trip
+        if (query_req->fetch_warnings && query_req->warning_count &&
+            !mysql_real_query(conn->_conn, "SHOW WARNINGS", 13)) {
+            query_req->warnings_result = mysql_store_result(conn->_conn);
+        }
     }
+    conn->last_activity = ev_time();
     pthread_mutex_unlock(&conn->query_lock);
     return 0;
 }
@@ -1043,19 +3279,61 @@ int MysqlConnection::EIO_Query(eio_req *req) {
 /**
  * Performs a query on the database
  *
- * @param {String} query
- * @param {Function(error, result)} callback
+ * @param {String|Buffer} query, Buffer is sent as is without copying
+ * @param {Object} options (optional), {warnings: true} also fetches
+ *        SHOW WARNINGS into info.warnings when query has warnings,
+ *        {priority: n} overrides connection priority for this query,
+ *        {coalesce: true} attaches read-only query to identical one
+ *        in flight and gives callback array of rows shared by all
+ *        attached callbacks, {coalesce: "copy"} gives own copy of rows.
+ *        Callbacks are called in order of calls, reads never attach
+ *        to ones submitted before other query on this connection
+ * @param {Function(error, result, info)} callback, info is
+ *        {affectedRows, insertId, warningCount, info} of this query
  */
 Handle<Value> MysqlConnection::Query(const Arguments& args) {
     HandleScope scope;
 #ifdef MYSQL_NON_THREADSAFE
     return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
 #else
-    REQ_STR_ARG(0, query);
-    REQ_FUN_ARG(1, callback);
+    if (args.Length() < 1 ||
+        (!args[0]->IsString() && !node::Buffer::HasInstance(args[0]))) {
+        return THRTYPEEXC("Argument 0 must be a string or Buffer");
+    }
 
     MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
 
+    int arg_pos = 1;
+    bool fetch_warnings = false;
+    int priority = conn->priority;
+    int coalesce = QUERY_COALESCE_NONE;
+
+    if (args.Length() > 1 && args[1]->IsObject() && !args[1]->IsFunction()) {
+        if (args[1]->ToObject()->Has(V8STR("warnings"))) {
+            fetch_warnings = args[1]->ToObject()
+                             ->Get(V8STR("warnings"))->BooleanValue();
+        }
+        if (args[1]->ToObject()->Has(V8STR("coalesce"))) {
+            Local<Value> js_coalesce =
+                args[1]->ToObject()->Get(V8STR("coalesce"));
+            if (js_coalesce->IsString() &&
+                !strcmp(*String::Utf8Value(js_coalesce), "copy")) {
+                coalesce = QUERY_COALESCE_COPY;
+            } else if (js_coalesce->BooleanValue()) {
+                coalesce = QUERY_COALESCE_SHARED;
+            }
+        }
+        if (args[1]->ToObject()->Has(V8STR("priority")) &&
+            !MysqlScheduler::PriorityArg(
+                args[1]->ToObject()->Get(V8STR("priority")), &priority)) {
+            return THRTYPEEXC("Priority must be an integer from "
+                              "MysqlScheduler.PRIORITY_MIN to PRIORITY_MAX");
+        }
+        arg_pos++;
+    }
+
+    REQ_FUN_ARG(arg_pos, callback);
+
     MYSQLCONN_MUSTBE_CONNECTED;
 
     struct query_request *query_req = (struct query_request *)
@@ -1066,19 +3344,81 @@ Handle<Value> MysqlConnection::Query(const Arguments& args) {
         return THREXC("Could not allocate enough memory");
     }
 
-    query_req->query =
-        reinterpret_cast<char *>(calloc(query.length() + 1,
-        sizeof(char))); // NOLINT (have no char var)
+    if (node::Buffer::HasInstance(args[0])) {
+        // Buffer memory doesn't move, keeping reference is enough
+        Local<Object> js_buffer = args[0]->ToObject();
+        query_req->query = node::Buffer::Data(js_buffer);
+        query_req->query_length = node::Buffer::Length(js_buffer);
+        query_req->query_buffer = Persistent<Object>::New(js_buffer);
+    } else {
+        // Encode straight into request memory, no intermediate Utf8Value
+        Local<String> js_query = args[0]->ToString();
+        int length = js_query->Utf8Length();
+
+        query_req->query = reinterpret_cast<char *>(malloc(length + 1));
+        if (!query_req->query) {
+            free(query_req);
+            V8::LowMemoryNotification();
+            return THREXC("Could not allocate enough memory");
+        }
+
+        js_query->WriteUtf8(query_req->query, length + 1);
+        query_req->query_length = length;
+    }
+
+    // Only reads are coalesced, writes must reach server each time
+    if (coalesce && !IsIdempotentQuery(query_req->query,
+                                       query_req->query_length)) {
+        coalesce = QUERY_COALESCE_NONE;
+    }
+
+    if (coalesce) {
+        struct query_request *inflight = conn->coalesce_inflight;
+        while (inflight &&
+               (inflight->query_length != query_req->query_length ||
+                inflight->fetch_warnings != fetch_warnings ||
+                memcmp(inflight->query, query_req->query,
+                       query_req->query_length))) {
+            inflight = inflight->next_inflight;
+        }
+
+        if (inflight) {
+            struct query_waiter *waiter = new query_waiter;
+            waiter->callback = Persistent<Function>::New(callback);
+            waiter->coalesce = coalesce;
+            waiter->next = NULL;
+
+            // Callbacks are called in order of query() calls
+            if (inflight->last_waiter) {
+                inflight->last_waiter->next = waiter;
+            } else {
+                inflight->waiters = waiter;
+            }
+            inflight->last_waiter = waiter;
+
+            if (query_req->query_buffer.IsEmpty()) {
+                free(query_req->query);
+            } else {
+                query_req->query_buffer.Dispose();
+            }
+            free(query_req);
+
+            return Undefined();
+        }
 
-    if (snprintf(query_req->query, query.length() + 1, "%s", *query) !=
-                                                      query.length()) {
-        return THREXC("Snprintf() error");
+        query_req->coalesce = coalesce;
+        query_req->next_inflight = conn->coalesce_inflight;
+        conn->coalesce_inflight = query_req;
+    } else {
+        // Reads submitted after this query must see its changes
+        conn->coalesce_inflight = NULL;
     }
 
     query_req->callback = Persistent<Function>::New(callback);
     query_req->conn = conn;
+    query_req->fetch_warnings = fetch_warnings;
 
-    eio_custom(EIO_Query, EIO_PRI_DEFAULT, EIO_After_Query, query_req);
+    MysqlScheduler::Submit(EIO_Query, EIO_After_Query, priority, query_req);
 
     ev_ref(EV_DEFAULT_UC);
     conn->Ref();
@@ -1090,7 +3430,7 @@ Handle<Value> MysqlConnection::Query(const Arguments& args) {
 /**
  * Performs a query on the database
  *
- * @param {String} query
+ * @param {String|Buffer} query
  * @param {MysqlResult} result
  */
 Handle<Value> MysqlConnection::QuerySync(const Arguments& args) {
@@ -1098,23 +3438,45 @@ Handle<Value> MysqlConnection::QuerySync(const Arguments& args) {
 
     MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
 
-    REQ_STR_ARG(0, query)
+    if (args.Length() < 1 ||
+        (!args[0]->IsString() && !node::Buffer::HasInstance(args[0]))) {
+        return THRTYPEEXC("Argument 0 must be a string or Buffer");
+    }
 
     MYSQLCONN_MUSTBE_CONNECTED;
 
-    MYSQLSYNC_DISABLE_MQ;
+    const char *query;
+    size_t query_length;
+    // Only used for strings, Buffers are sent directly
+    String::Utf8Value query_string(args[0]->IsString() ?
+                                   args[0] : Local<Value>::New(Undefined()));
+
+    if (node::Buffer::HasInstance(args[0])) {
+        query = node::Buffer::Data(args[0]->ToObject());
+        query_length = node::Buffer::Length(args[0]->ToObject());
+    } else {
+        query = *query_string;
+        query_length = query_string.length();
+    }
+
+    MYSQLCONN_MUSTNOT_LOAD_STREAM(conn);
+
     MYSQL_RES *my_result = NULL;
     int field_count;
 
     // Only one query can be executed on a connection at a time
     pthread_mutex_lock(&conn->query_lock);
 
-    int r = mysql_query(conn->_conn, *query);
+    MYSQLSYNC_DISABLE_MQ;
+    conn->TrackSessionState(query, query_length);
+
+    int r = mysql_real_query(conn->_conn, query, query_length);
     if (r == 0) {
         my_result = mysql_store_result(conn->_conn);
         field_count = mysql_field_count(conn->_conn);
     }
 
+    conn->last_activity = ev_time();
     pthread_mutex_unlock(&conn->query_lock);
 
     if (r != 0) {
@@ -1132,16 +3494,119 @@ Handle<Value> MysqlConnection::QuerySync(const Arguments& args) {
         }
     }
 
-    int argc = 2;
-    Local<Value> argv[2];
+    int argc = 3;
+    Local<Value> argv[3];
     argv[0] = External::New(my_result);
     argv[1] = Integer::New(field_count);
+    argv[2] = Integer::New(conn->priority);
     Persistent<Object> js_result(MysqlResult::constructor_template->
                              GetFunction()->NewInstance(argc, argv));
 
     return scope.Close(js_result);
 }
 
+/**
+ * EIO wrapper functions for MysqlConnection::Reset
+ */
+#ifndef MYSQL_NON_THREADSAFE
+int MysqlConnection::EIO_After_Reset(eio_req *req) {
+    ev_unref(EV_DEFAULT_UC);
+    HandleScope scope;
+    struct reset_request *reset_req =
+        reinterpret_cast<struct reset_request *>(req->data);
+
+    Local<Value> argv[1];
+
+    if (req->result) {
+        argv[0] = V8EXC(reset_req->error ?
+                        reset_req->error : "Error on session reset");
+    } else {
+        argv[0] = Local<Value>::New(Null());
+    }
+
+    TryCatch try_catch;
+
+    reset_req->callback->Call(Context::GetCurrent()->Global(), 1, argv);
+
+    if (try_catch.HasCaught()) {
+        node::FatalException(try_catch);
+    }
+
+    reset_req->callback.Dispose();
+    reset_req->conn->Unref();
+    free(reset_req->error);
+    free(reset_req);
+
+    return 0;
+}
+
+int MysqlConnection::EIO_Reset(eio_req *req) {
+    struct reset_request *reset_req =
+        reinterpret_cast<struct reset_request *>(req->data);
+    MysqlConnection *conn = reset_req->conn;
+
+    req->result = 0;
+
+    pthread_mutex_lock(&conn->query_lock);
+
+    const char *error = NULL;
+    if (!conn->_conn) {
+        req->result = 1;
+        reset_req->error = strdup("Not connected");
+    } else if (!conn->ResetSession(&error)) {
+        req->result = 1;
+        reset_req->error = strdup(error);
+    }
+
+    conn->last_activity = ev_time();
+    pthread_mutex_unlock(&conn->query_lock);
+
+    return 0;
+}
+#endif
+
+/**
+ * Resets session state without reconnect, faster than changeUserSync()
+ * when client library and server support mysql_reset_connection()
+ *
+ * @param {Function(error)} callback
+ */
+Handle<Value> MysqlConnection::Reset(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    REQ_FUN_ARG(0, callback);
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    struct reset_request *reset_req =
+        reinterpret_cast<struct reset_request *>(
+            calloc(1, sizeof(struct reset_request)));
+
+    if (!reset_req) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    reset_req->callback = Persistent<Function>::New(callback);
+    reset_req->conn = conn;
+
+    // Later identical reads must not attach to earlier ones
+    conn->coalesce_inflight = NULL;
+
+    MysqlScheduler::Submit(EIO_Reset, EIO_After_Reset,
+                           conn->priority, reset_req);
+
+    ev_ref(EV_DEFAULT_UC);
+    conn->Ref();
+
+    return Undefined();
+#endif
+}
+
 /**
  * Rolls back current transaction
  *
@@ -1243,11 +3708,15 @@ Handle<Value> MysqlConnection::RealQuerySync(const Arguments& args) {
 
     MYSQLCONN_MUSTBE_CONNECTED;
 
-    MYSQLSYNC_DISABLE_MQ;
-
+    MYSQLCONN_MUSTNOT_LOAD_STREAM(conn);
 
     pthread_mutex_lock(&conn->query_lock);
+
+    MYSQLSYNC_DISABLE_MQ;
+    conn->TrackSessionState(*query, query.length());
+
     int r = mysql_real_query(conn->_conn, *query, query.length());
+    conn->last_activity = ev_time();
     pthread_mutex_unlock(&conn->query_lock);
 
     if (r != 0) {
@@ -1272,10 +3741,18 @@ Handle<Value> MysqlConnection::SelectDbSync(const Arguments& args) {
 
     REQ_STR_ARG(0, dbname)
 
+    if (conn->dbname_known && conn->saved_dbname &&
+        !strcmp(conn->saved_dbname, *dbname)) {
+        return scope.Close(True());
+    }
+
     if (mysql_select_db(conn->_conn, *dbname)) {
         return scope.Close(False());
     }
 
+    SaveString(&conn->saved_dbname, *dbname);
+    conn->dbname_known = true;
+
     return scope.Close(True());
 }
 
@@ -1294,11 +3771,57 @@ Handle<Value> MysqlConnection::SetCharsetSync(const Arguments& args) {
 
     REQ_STR_ARG(0, charset)
 
+    if (conn->charset_known &&
+        !strcasecmp(mysql_character_set_name(conn->_conn), *charset)) {
+        SaveString(&conn->saved_charset, *charset);
+        return scope.Close(True());
+    }
+
     if (mysql_set_character_set(conn->_conn, *charset)) {
         return scope.Close(False());
     }
 
+    SaveString(&conn->saved_charset, *charset);
+    conn->charset_known = true;
+
+    return scope.Close(True());
+}
+
+/**
+ * Starts pinging connection from worker thread when it has been idle
+ * for interval, dead connections are reconnected if setReconnectSync()
+ * is enabled or marked as not connected. Each ping emits "keepalive"
+ * event with error and round trip time in ms. Timer doesn't keep
+ * event loop running
+ *
+ * @param {Integer} interval in ms, 0 disables keepalive
+ * @return {Boolean}
+ */
+Handle<Value> MysqlConnection::SetKeepaliveSync(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    REQ_UINT_ARG(0, interval)
+
+    if (conn->keepalive_interval) {
+        ev_ref(EV_DEFAULT_UC);
+        ev_timer_stop(EV_DEFAULT_UC, &conn->keepalive_timer);
+    }
+
+    conn->keepalive_interval = interval/1000.0;
+
+    if (conn->keepalive_interval) {
+        ev_timer_set(&conn->keepalive_timer,
+                     conn->keepalive_interval, conn->keepalive_interval);
+        ev_timer_start(EV_DEFAULT_UC, &conn->keepalive_timer);
+        ev_unref(EV_DEFAULT_UC);
+    }
+
     return scope.Close(True());
+#endif
 }
 
 /**
@@ -1332,6 +3855,9 @@ Handle<Value> MysqlConnection::SetOptionSync(const Arguments& args) {
                               static_cast<const char *>(
                                 static_cast<const void *>(
                                   &option_integer_value)));
+            if (!r) {
+                conn->SaveOption(option_key, NULL, option_integer_value);
+            }
             }
             break;
         case MYSQL_READ_DEFAULT_FILE:
@@ -1342,6 +3868,9 @@ Handle<Value> MysqlConnection::SetOptionSync(const Arguments& args) {
             {
             REQ_STR_ARG(1, option_string_value);
             r = mysql_options(conn->_conn, option_key, *option_string_value);
+            if (!r) {
+                conn->SaveOption(option_key, *option_string_value, 0);
+            }
             }
             break;
         default:
@@ -1355,6 +3884,67 @@ Handle<Value> MysqlConnection::SetOptionSync(const Arguments& args) {
     return scope.Close(True());
 }
 
+/**
+ * Sets thread pool priority of asynchronous calls on this connection,
+ * calls below MysqlScheduler.PRIORITY_DEFAULT are low priority ones
+ *
+ * @param {Integer} priority
+ */
+Handle<Value> MysqlConnection::SetPrioritySync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    int priority;
+
+    if (args.Length() < 1 ||
+        !MysqlScheduler::PriorityArg(args[0], &priority)) {
+        return THRTYPEEXC("Priority must be an integer from "
+                          "MysqlScheduler.PRIORITY_MIN to PRIORITY_MAX");
+    }
+
+    conn->priority = priority;
+
+    return Undefined();
+}
+
+/**
+ * Enables automatic reconnect for query(), connect arguments, selected
+ * database, charset, autocommit mode, options and SSL settings are
+ * restored after reconnect. Unlike MYSQL_OPT_RECONNECT option session
+ * state is not lost. Only read-only autocommitted queries are retried,
+ * other queries fail with the connection error after reconnect
+ *
+ * @param {Boolean} enable
+ * @param {Integer|null} attempts, 5 by default
+ * @param {Integer|null} initial delay between attempts in ms, 100 by default
+ * @return {Boolean}
+ */
+Handle<Value> MysqlConnection::SetReconnectSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    REQ_BOOL_ARG(0, enable)
+
+    if (args.Length() > 1 && !args[1]->IsNull() && !args[1]->IsUndefined()) {
+        REQ_UINT_ARG(1, attempts)
+        if (!attempts) {
+            return THRTYPEEXC("Attempts count must be positive");
+        }
+        conn->reconnect_attempts = attempts;
+    }
+
+    if (args.Length() > 2 && !args[2]->IsNull() && !args[2]->IsUndefined()) {
+        REQ_UINT_ARG(2, delay)
+        conn->reconnect_delay = delay;
+    }
+
+    conn->reconnect = enable;
+
+    return scope.Close(True());
+}
+
 /**
  * Sets SSL options
  * Used for establishing secure connections
@@ -1380,6 +3970,13 @@ Handle<Value> MysqlConnection::SetSslSync(const Arguments& args) {
 
     mysql_ssl_set(conn->_conn, *key, *cert, *ca, *capath, *cipher);
 
+    SaveString(&conn->saved_ssl[0], *key);
+    SaveString(&conn->saved_ssl[1], *cert);
+    SaveString(&conn->saved_ssl[2], *ca);
+    SaveString(&conn->saved_ssl[3], *capath);
+    SaveString(&conn->saved_ssl[4], *cipher);
+    conn->saved_ssl_set = true;
+
     return scope.Close(Undefined());
 }
 
@@ -1436,10 +4033,11 @@ Handle<Value> MysqlConnection::StoreResultSync(const Arguments& args) {
         return scope.Close(False());
     }
 
-    int argc = 2;
-    Local<Value> argv[2];
+    int argc = 3;
+    Local<Value> argv[3];
     argv[0] = External::New(my_result);
     argv[1] = Integer::New(mysql_field_count(conn->_conn));
+    argv[2] = Integer::New(conn->priority);
     Persistent<Object> js_result(MysqlResult::constructor_template->
                              GetFunction()->NewInstance(argc, argv));
 
@@ -1478,6 +4076,292 @@ Handle<Value> MysqlConnection::ThreadSafeSync(const Arguments& args) {
     }
 }
 
+/**
+ * EIO wrapper functions for MysqlConnection::Transaction
+ */
+#ifndef MYSQL_NON_THREADSAFE
+int MysqlConnection::EIO_After_Transaction(eio_req *req) {
+    ev_unref(EV_DEFAULT_UC);
+    HandleScope scope;
+    struct transaction_request *trans_req =
+        reinterpret_cast<struct transaction_request *>(req->data);
+
+    int argc = 1;
+    Local<Value> argv[2];
+
+    if (req->result) {
+        Local<Object> js_error = V8EXC(trans_req->error ?
+                        trans_req->error : "Error on transaction")->ToObject();
+        js_error->Set(V8STR("index"), Integer::New(trans_req->error_index));
+        argv[0] = js_error;
+
+        for (uint32_t i = 0; i < trans_req->statements_count; i++) {
+            if (trans_req->results[i].my_result) {
+                mysql_free_result(trans_req->results[i].my_result);
+            }
+        }
+    } else {
+        Local<Array> js_results = Array::New(trans_req->statements_count);
+
+        for (uint32_t i = 0; i < trans_req->statements_count; i++) {
+            struct transaction_result *result = &trans_req->results[i];
+
+            if (result->my_result) {
+                Local<Value> result_argv[3];
+                result_argv[0] = External::New(result->my_result);
+                result_argv[1] = Integer::NewFromUnsigned(result->field_count);
+                result_argv[2] = Integer::New(trans_req->conn->priority);
+                js_results->Set(Integer::New(i),
+                    MysqlResult::constructor_template->
+                        GetFunction()->NewInstance(3, result_argv));
+            } else {
+                Local<Object> js_info = Object::New();
+                js_info->Set(V8STR("affectedRows"),
+                    Number::New(static_cast<double>(result->affected_rows)));
+                js_info->Set(V8STR("insertId"),
+                    Number::New(static_cast<double>(result->insert_id)));
+                js_results->Set(Integer::New(i), js_info);
+            }
+        }
+
+        argv[0] = Local<Value>::New(Null());
+        argv[1] = js_results;
+        argc = 2;
+    }
+
+    TryCatch try_catch;
+
+    trans_req->callback->Call(Context::GetCurrent()->Global(), argc, argv);
+
+    if (try_catch.HasCaught()) {
+        node::FatalException(try_catch);
+    }
+
+    trans_req->callback.Dispose();
+    trans_req->conn->Unref();
+    free(trans_req->query);
+    free(trans_req->offsets);
+    free(trans_req->results);
+    free(trans_req->error);
+    free(trans_req);
+
+    return 0;
+}
+
+int MysqlConnection::EIO_Transaction(eio_req *req) {
+    struct transaction_request *trans_req =
+        reinterpret_cast<struct transaction_request *>(req->data);
+    MysqlConnection *conn = trans_req->conn;
+
+    req->result = 0;
+
+    pthread_mutex_lock(&conn->query_lock);
+
+    if (!conn->_conn) {
+        req->result = 1;
+        trans_req->error = strdup("Not connected");
+        pthread_mutex_unlock(&conn->query_lock);
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < trans_req->statements_count; i++) {
+        conn->TrackSessionState(trans_req->query + trans_req->offsets[i],
+            trans_req->query_length - trans_req->offsets[i]);
+    }
+
+    MYSQLSYNC_ENABLE_MQ;
+
+    int32_t index = -1;
+    int status = mysql_real_query(conn->_conn, trans_req->query,
+                                  trans_req->query_length);
+
+    if (!status) {
+        do {
+            MYSQL_RES *my_result = mysql_store_result(conn->_conn);
+            uint32_t field_count = mysql_field_count(conn->_conn);
+
+            if (!my_result && field_count) {
+                // Result store error, rest must be read before ROLLBACK
+                status = 1;
+                trans_req->error = strdup(mysql_error(conn->_conn));
+                while (mysql_more_results(conn->_conn) &&
+                       !mysql_next_result(conn->_conn)) {
+                    my_result = mysql_store_result(conn->_conn);
+                    if (my_result) {
+                        mysql_free_result(my_result);
+                    }
+                }
+                break;
+            }
+
+            if (index >= 0 &&
+                index < static_cast<int32_t>(trans_req->statements_count)) {
+                struct transaction_result *result = &trans_req->results[index];
+                result->my_result = my_result;
+                result->field_count = field_count;
+                result->affected_rows = mysql_affected_rows(conn->_conn);
+                result->insert_id = mysql_insert_id(conn->_conn);
+            } else if (my_result) {
+                mysql_free_result(my_result);
+            }
+
+            index++;
+            // Server stops executing statements after first error
+            status = mysql_next_result(conn->_conn);
+        } while (!status);
+
+        if (status < 0) {
+            status = 0;
+        }
+    }
+
+    if (!status &&
+        index != static_cast<int32_t>(trans_req->statements_count)) {
+        // Some element held several statements, results don't match them
+        status = 1;
+        index = trans_req->statements_count;
+        trans_req->error = strdup("Statements count doesn't match results, "
+                                  "each element must hold one statement");
+    }
+
+    if (!status) {
+        // Sent only now, so nothing is committed when results don't match
+        index = trans_req->statements_count;
+        status = mysql_real_query(conn->_conn, "COMMIT", 6);
+    }
+
+    if (status) {
+        req->result = 1;
+        trans_req->error_index = index;
+        if (!trans_req->error) {
+            trans_req->error = strdup(mysql_error(conn->_conn));
+        }
+
+        mysql_real_query(conn->_conn, "ROLLBACK", 8);
+    }
+
+    conn->last_activity = ev_time();
+    pthread_mutex_unlock(&conn->query_lock);
+
+    return 0;
+}
+#endif
+
+/**
+ * Executes statements in transaction sending them to server
+ * in one packet and COMMIT after them, on error transaction is
+ * rolled back and error has index of failed statement (-1 for
+ * START TRANSACTION and statements count for COMMIT or results
+ * count mismatch). Statements are sent with multi statements on
+ * like multiRealQuerySync(), so values in them must be escaped.
+ * Element with several statements is rolled back unless one of them
+ * commits implicitly
+ *
+ * @param {Array} statements
+ * @param {Function(error, results)} callback, results contain MysqlResult
+ *                                   or {affectedRows, insertId} for each statement
+ */
+Handle<Value> MysqlConnection::Transaction(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    if (args.Length() < 1 || !args[0]->IsArray()) {
+        return THRTYPEEXC("Argument 0 must be an array");
+    }
+    REQ_FUN_ARG(1, callback);
+
+    MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(args.This());
+
+    MYSQLCONN_MUSTBE_CONNECTED;
+
+    Local<Array> js_statements = Local<Array>::Cast(args[0]);
+    uint32_t statements_count = js_statements->Length();
+
+    size_t query_size = sizeof("START TRANSACTION;");
+    for (uint32_t i = 0; i < statements_count; i++) {
+        Local<Value> js_statement = js_statements->Get(Integer::New(i));
+        if (!js_statement->IsString()) {
+            return THRTYPEEXC("Statements must be strings");
+        }
+        query_size += js_statement->ToString()->Utf8Length() + 2;
+    }
+
+    struct transaction_request *trans_req =
+        reinterpret_cast<struct transaction_request *>(
+            calloc(1, sizeof(struct transaction_request)));
+
+    if (!trans_req) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    trans_req->query = reinterpret_cast<char *>(malloc(query_size));
+    trans_req->offsets = reinterpret_cast<size_t *>(
+        calloc(statements_count + 1, sizeof(size_t)));
+    trans_req->results = reinterpret_cast<struct transaction_result *>(
+        calloc(statements_count + 1, sizeof(struct transaction_result)));
+
+    if (!trans_req->query || !trans_req->offsets || !trans_req->results) {
+        free(trans_req->query);
+        free(trans_req->offsets);
+        free(trans_req->results);
+        free(trans_req);
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    char *query = trans_req->query;
+    memcpy(query, "START TRANSACTION;", 18);
+    query += 18;
+
+    for (uint32_t i = 0; i < statements_count; i++) {
+        String::Utf8Value statement(js_statements->Get(Integer::New(i)));
+        size_t length = statement.length();
+
+        // Trailing semicolons would become empty statements
+        while (length && (isspace((*statement)[length - 1]) ||
+                          (*statement)[length - 1] == ';')) {
+            length--;
+        }
+
+        if (!length) {
+            free(trans_req->query);
+            free(trans_req->offsets);
+            free(trans_req->results);
+            free(trans_req);
+            return THRTYPEEXC("Statements must be non-empty");
+        }
+
+        // Trailing "-- " or "#" comment must not hide next statement
+        if (i) {
+            *query++ = '\n';
+            *query++ = ';';
+        }
+        trans_req->offsets[i] = query - trans_req->query;
+        memcpy(query, *statement, length);
+        query += length;
+    }
+    *query++ = '\n';
+
+    trans_req->query_length = query - trans_req->query;
+    trans_req->statements_count = statements_count;
+    trans_req->callback = Persistent<Function>::New(callback);
+    trans_req->conn = conn;
+
+    // Later identical reads must not attach to earlier ones
+    conn->coalesce_inflight = NULL;
+
+    MysqlScheduler::Submit(EIO_Transaction, EIO_After_Transaction,
+                           conn->priority, trans_req);
+
+    ev_ref(EV_DEFAULT_UC);
+    conn->Ref();
+
+    return Undefined();
+#endif
+}
+
 /**
  * Initiates a result set retrieval
  *
@@ -1499,10 +4383,11 @@ Handle<Value> MysqlConnection::UseResultSync(const Arguments& args) {
         return scope.Close(False());
     }
 
-    int argc = 2;
-    Local<Value> argv[2];
+    int argc = 3;
+    Local<Value> argv[3];
     argv[0] = External::New(my_result);
     argv[1] = Integer::New(mysql_field_count(conn->_conn));
+    argv[2] = Integer::New(conn->priority);
     Persistent<Object> js_result(MysqlResult::constructor_template->
                              GetFunction()->NewInstance(argc, argv));
 
@@ -9,23 +9,33 @@ See license text in LICENSE file
 #define NODE_MYSQL_CONNECTION_H
 
 #include <mysql.h>
+#include <errmsg.h>
 
 #include <v8.h>
 #include <node.h>
+#include <node_buffer.h>
 #include <node_events.h>
 
 #include <unistd.h>
 #include <pthread.h>
 
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "./mysql_bindings.h"
+#include "./mysql_bindings_scheduler.h"
 
 using namespace v8; // NOLINT
 
 static Persistent<String> connection_affectedRowsSync_symbol;
 static Persistent<String> connection_autoCommitSync_symbol;
+static Persistent<String> connection_bulkInsert_symbol;
 static Persistent<String> connection_changeUserSync_symbol;
 static Persistent<String> connection_commitSync_symbol;
 static Persistent<String> connection_connect_symbol;
@@ -36,6 +46,8 @@ static Persistent<String> connection_debugSync_symbol;
 static Persistent<String> connection_dumpDebugInfoSync_symbol;
 static Persistent<String> connection_errnoSync_symbol;
 static Persistent<String> connection_errorSync_symbol;
+static Persistent<String> connection_escapeBuffer_symbol;
+static Persistent<String> connection_escapeMany_symbol;
 static Persistent<String> connection_escapeSync_symbol;
 static Persistent<String> connection_fieldCountSync_symbol;
 static Persistent<String> connection_getCharsetSync_symbol;
@@ -46,28 +58,39 @@ static Persistent<String> connection_getWarningsSync_symbol;
 static Persistent<String> connection_initSync_symbol;
 static Persistent<String> connection_initStatementSync_symbol;
 static Persistent<String> connection_lastInsertIdSync_symbol;
+static Persistent<String> connection_loadData_symbol;
+static Persistent<String> connection_lookup_symbol;
 static Persistent<String> connection_multiMoreResultsSync_symbol;
 static Persistent<String> connection_multiNextResultSync_symbol;
 static Persistent<String> connection_multiRealQuerySync_symbol;
+static Persistent<String> connection_ping_symbol;
 static Persistent<String> connection_pingSync_symbol;
 static Persistent<String> connection_query_symbol;
 static Persistent<String> connection_querySync_symbol;
 static Persistent<String> connection_realConnectSync_symbol;
 static Persistent<String> connection_realQuerySync_symbol;
+static Persistent<String> connection_reset_symbol;
 static Persistent<String> connection_rollbackSync_symbol;
 static Persistent<String> connection_selectDbSync_symbol;
 static Persistent<String> connection_setCharsetSync_symbol;
+static Persistent<String> connection_setKeepaliveSync_symbol;
 static Persistent<String> connection_setOptionSync_symbol;
+static Persistent<String> connection_setPrioritySync_symbol;
+static Persistent<String> connection_setReconnectSync_symbol;
 static Persistent<String> connection_setSslSync_symbol;
 static Persistent<String> connection_sqlStateSync_symbol;
 static Persistent<String> connection_statSync_symbol;
 static Persistent<String> connection_storeResultSync_symbol;
 static Persistent<String> connection_threadIdSync_symbol;
 static Persistent<String> connection_threadSafeSync_symbol;
+static Persistent<String> connection_transaction_symbol;
 static Persistent<String> connection_useResultSync_symbol;
 static Persistent<String> connection_warningCountSync_symbol;
 
 class MysqlConnection : public node::EventEmitter {
+  friend class MysqlShardMap;
+  friend class MysqlStatement;
+
   public:
     static Persistent<FunctionTemplate> constructor_template;
 
@@ -98,6 +121,21 @@ class MysqlConnection : public node::EventEmitter {
 
     void Close();
 
+    bool Reconnect();
+
+    bool ResetSession(const char **error);
+
+    static bool IsIdempotentQuery(const char *query, size_t length);
+
+    void TrackSessionState(const char *query, size_t length);
+
+    int ExecuteQuery(const char *query, size_t length);
+
+    int EscapeMode();
+
+    unsigned long Escape(char *to, const char *from,  // NOLINT
+                         unsigned long length, int mode);  // NOLINT
+
     MysqlConnectionInfo GetInfo();
 
   protected:
@@ -108,8 +146,65 @@ class MysqlConnection : public node::EventEmitter {
 
     bool multi_query;
 
+    // loadData() calls from stream, Sync calls taking query_lock throw
+    uint32_t stream_loads;
+
     unsigned int connect_errno;
-    const char *connect_error;
+    char *connect_error;
+
+    // Session state replayed by Reconnect()
+    struct saved_option {
+        mysql_option option;
+        char *string_value;
+        unsigned int integer_value;
+        struct saved_option *next;
+    };
+    // Thread pool priority of asynchronous calls
+    int priority;
+    bool reconnect;
+    uint32_t reconnect_attempts;
+    uint32_t reconnect_delay;
+    char *saved_hostname;
+    char *saved_user;
+    char *saved_password;
+    char *saved_dbname;
+    uint32_t saved_port;
+    char *saved_socket;
+    char *saved_charset;
+    int saved_autocommit;
+    struct saved_option *saved_options;
+    // False after USE or SET query changed state behind our back
+    bool dbname_known;
+    bool charset_known;
+    // key, cert, ca, capath and cipher from setSslSync()
+    char *saved_ssl[5];
+    bool saved_ssl_set;
+
+    static void SaveString(char **to, const char *from);
+
+    void SaveConnectArgs(const char* hostname,
+                         const char* user,
+                         const char* password,
+                         const char* dbname,
+                         uint32_t port,
+                         const char* socket);
+
+    void SaveOption(mysql_option option, const char *string_value,
+                    unsigned int integer_value);
+
+    void FreeSavedState();
+
+    void SetConnectError();
+
+    // Keepalive pings idle connection from worker thread
+    ev_timer keepalive_timer;
+    ev_tstamp keepalive_interval;
+    bool keepalive_pending;
+    // Time of last server round trip, guarded by query_lock
+    ev_tstamp last_activity;
+
+    // Server max_allowed_packet, fetched by first bulkInsert() call
+    unsigned long max_allowed_packet;  // NOLINT (unsigned long required by API)
 
     MysqlConnection();
 
@@ -133,6 +228,33 @@ class MysqlConnection : public node::EventEmitter {
 
     static Handle<Value> AutoCommitSync(const Arguments& args);
 
+#ifndef MYSQL_NON_THREADSAFE
+    struct bulkInsert_request {
+        Persistent<Function> callback;
+        MysqlConnection *conn;
+
+        // "INSERT INTO `table` (`column`, ...) VALUES "
+        char *prefix;
+        size_t prefix_length;
+
+        // Raw cell values in one arena, escaped by worker
+        char *cells;
+        size_t *cell_offsets;
+        size_t *cell_lengths;
+        char *cell_types;
+        uint32_t columns_count;
+        uint32_t rows_count;
+
+        uint32_t statements_count;
+        my_ulonglong affected_rows;
+        char *error;
+    };
+    static int EIO_After_BulkInsert(eio_req *req);
+    static int EIO_BulkInsert(eio_req *req);
+    static size_t QuoteIdentifier(char *to, const char *from, size_t length);
+#endif
+    static Handle<Value> BulkInsert(const Arguments& args);
+
     static Handle<Value> ChangeUserSync(const Arguments& args);
 
     static Handle<Value> CommitSync(const Arguments& args);
@@ -167,6 +289,10 @@ class MysqlConnection : public node::EventEmitter {
 
     static Handle<Value> ErrorSync(const Arguments& args);
 
+    static Handle<Value> EscapeBuffer(const Arguments& args);
+
+    static Handle<Value> EscapeMany(const Arguments& args);
+
     static Handle<Value> EscapeSync(const Arguments& args);
 
     static Handle<Value> FieldCountSync(const Arguments& args);
@@ -179,6 +305,7 @@ class MysqlConnection : public node::EventEmitter {
 
     static Handle<Value> GetInfoStringSync(const Arguments& args);
 
+    static Local<Array> WarningsToArray(MYSQL_RES *result);
     static Handle<Value> GetWarningsSync(const Arguments& args);
 
     static Handle<Value> InitSync(const Arguments& args);
@@ -187,24 +314,168 @@ class MysqlConnection : public node::EventEmitter {
 
     static Handle<Value> LastInsertIdSync(const Arguments& args);
 
+#ifndef MYSQL_NON_THREADSAFE
+    struct loadData_request {
+        Persistent<Function> callback;
+        MysqlConnection *conn;
+        String::Utf8Value *query;
+
+        // Buffer source is copied and read in place
+        Persistent<Object> js_source;
+        char *source_copy;
+        const char *source_data;
+        size_t source_length;
+
+        // Stream source feeds ring buffer, chunks that don't fit
+        // wait in js_pending and the stream is paused
+        Persistent<Array> js_pending;
+        size_t pending_offset;
+        Persistent<Function> on_data;
+        Persistent<Function> on_end;
+        Persistent<Function> on_error;
+        bool stream_ended;
+        bool stream_paused;
+        ev_async drained_watcher;
+
+        pthread_mutex_t lock;
+        pthread_cond_t cond;
+        char *ring;
+        size_t ring_size;
+        size_t ring_start;
+        size_t ring_used;
+        bool ended;
+        bool aborted;
+
+        my_ulonglong affected_rows;
+        char *error;
+    };
+    static int EIO_After_LoadData(eio_req *req);
+    static int EIO_LoadData(eio_req *req);
+    static int LoadDataInfileInit(void **ptr, const char *filename,
+                                  void *userdata);
+    static int LoadDataInfileRead(void *ptr, char *buf, unsigned int buf_len);
+    static void LoadDataInfileEnd(void *ptr);
+    static int LoadDataInfileError(void *ptr, char *error_msg,
+                                   unsigned int error_msg_len);
+    static void LoadDataFlushPending(struct loadData_request *load_req);
+    static void LoadDataDrained(EV_P_ ev_async *watcher, int revents);
+    static Persistent<Function> load_data_on_data;
+    static Persistent<Function> load_data_on_end;
+    static Persistent<Function> load_data_on_error;
+    static Handle<Value> LoadDataOnData(const Arguments& args);
+    static Handle<Value> LoadDataOnEnd(const Arguments& args);
+    static Handle<Value> LoadDataOnError(const Arguments& args);
+#endif
+    static Handle<Value> LoadData(const Arguments& args);
+
+#ifndef MYSQL_NON_THREADSAFE
+    struct lookup_caller {
+        Persistent<Function> callback;
+        char *key;
+        size_t key_length;
+        // Index of first caller with same key
+        uint32_t unique_index;
+    };
+    struct lookup_request {
+        MysqlConnection *conn;
+        char *table;
+        char *key_column;
+        struct lookup_caller *callers;
+        uint32_t callers_count;
+        uint32_t callers_capacity;
+
+        // Rows for each unique key are chained in worker
+        MYSQL_RES *my_result;
+        MYSQL_ROW *rows;
+        unsigned long *lengths;  // NOLINT (unsigned long required by API)
+        uint32_t rows_count;
+        uint32_t fields_count;
+        int32_t *first_row;
+        int32_t *last_row;
+        int32_t *next_row;
+
+        char *error;
+        struct lookup_request *next;
+    };
+    // Batches collected during current event loop tick
+    struct lookup_request *lookup_pending;
+    ev_timer lookup_timer;
+    static uint32_t LookupHash(const char *key, size_t length);
+    static void LookupTimer(EV_P_ ev_timer *watcher, int revents);
+    static void FreeLookup(struct lookup_request *lookup_req);
+    static int EIO_After_Lookup(eio_req *req);
+    static int EIO_Lookup(eio_req *req);
+#endif
+    static Handle<Value> Lookup(const Arguments& args);
+
     static Handle<Value> MultiMoreResultsSync(const Arguments& args);
 
     static Handle<Value> MultiNextResultSync(const Arguments& args);
 
     static Handle<Value> MultiRealQuerySync(const Arguments& args);
 
+#ifndef MYSQL_NON_THREADSAFE
+    struct ping_request {
+        Persistent<Function> callback;
+        MysqlConnection *conn;
+        bool keepalive;
+        bool skipped;
+        bool reconnected;
+        double rtt;
+        char *error;
+    };
+    static int EIO_After_Ping(eio_req *req);
+    static int EIO_Ping(eio_req *req);
+    static void KeepaliveTimer(EV_P_ ev_timer *watcher, int revents);
+#endif
+    static Handle<Value> Ping(const Arguments& args);
+
     static Handle<Value> PingSync(const Arguments& args);
 
 #ifndef MYSQL_NON_THREADSAFE
+    // Modes of {coalesce: ...} query option
+    enum query_coalesce_mode {
+        QUERY_COALESCE_NONE = 0,
+        QUERY_COALESCE_SHARED,
+        QUERY_COALESCE_COPY
+    };
+    // Callback attached to identical query already in flight
+    struct query_waiter {
+        Persistent<Function> callback;
+        int coalesce;
+        struct query_waiter *next;
+    };
     struct query_request {
         Persistent<Function> callback;
         MysqlConnection *conn;
+        // Points into query_buffer when query is a Buffer,
+        // otherwise owned copy of the string
         char *query;
+        size_t query_length;
+        Persistent<Object> query_buffer;
         MYSQL_RES *my_result;
         uint32_t field_count;
+        // Captured under query_lock, later queries can't overwrite them
+        my_ulonglong affected_rows;
+        my_ulonglong insert_id;
+        unsigned int warning_count;
+        char *info;
+        // SHOW WARNINGS fetched in the same job when requested
+        bool fetch_warnings;
+        MYSQL_RES *warnings_result;
+        unsigned int error_errno;
+        char *error;
+        // Coalesced queries get rows instead of MysqlResult
+        int coalesce;
+        struct query_waiter *waiters;
+        struct query_waiter *last_waiter;
+        struct query_request *next_inflight;
     };
+    // Coalescable queries in flight, looked up by query text
+    struct query_request *coalesce_inflight;
     static int EIO_After_Query(eio_req *req);
     static int EIO_Query(eio_req *req);
+    static Local<Array> CopyRows(Local<Array> js_rows);
 #endif
     static Handle<Value> Query(const Arguments& args);
 
@@ -214,14 +485,31 @@ class MysqlConnection : public node::EventEmitter {
 
     static Handle<Value> RealQuerySync(const Arguments& args);
 
+#ifndef MYSQL_NON_THREADSAFE
+    struct reset_request {
+        Persistent<Function> callback;
+        MysqlConnection *conn;
+        char *error;
+    };
+    static int EIO_After_Reset(eio_req *req);
+    static int EIO_Reset(eio_req *req);
+#endif
+    static Handle<Value> Reset(const Arguments& args);
+
     static Handle<Value> RollbackSync(const Arguments& args);
 
     static Handle<Value> SelectDbSync(const Arguments& args);
 
     static Handle<Value> SetCharsetSync(const Arguments& args);
 
+    static Handle<Value> SetKeepaliveSync(const Arguments& args);
+
     static Handle<Value> SetOptionSync(const Arguments& args);
 
+    static Handle<Value> SetPrioritySync(const Arguments& args);
+
+    static Handle<Value> SetReconnectSync(const Arguments& args);
+
     static Handle<Value> SetSslSync(const Arguments& args);
 
     static Handle<Value> SqlStateSync(const Arguments& args);
@@ -234,6 +522,33 @@ class MysqlConnection : public node::EventEmitter {
 
     static Handle<Value> ThreadSafeSync(const Arguments& args);
 
+#ifndef MYSQL_NON_THREADSAFE
+    struct transaction_result {
+        MYSQL_RES *my_result;
+        uint32_t field_count;
+        my_ulonglong affected_rows;
+        my_ulonglong insert_id;
+    };
+    struct transaction_request {
+        Persistent<Function> callback;
+        MysqlConnection *conn;
+
+        // "START TRANSACTION;...\n;...\n" and statements offsets in it
+        char *query;
+        size_t query_length;
+        size_t *offsets;
+        uint32_t statements_count;
+
+        struct transaction_result *results;
+        // -1 for START TRANSACTION, statements_count for COMMIT
+        int32_t error_index;
+        char *error;
+    };
+    static int EIO_After_Transaction(eio_req *req);
+    static int EIO_Transaction(eio_req *req);
+#endif
+    static Handle<Value> Transaction(const Arguments& args);
+
     static Handle<Value> UseResultSync(const Arguments& args);
 
     static Handle<Value> WarningCountSync(const Arguments& args);
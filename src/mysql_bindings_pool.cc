@@ -0,0 +1,842 @@
+/*!
+ * Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+ * See contributors list in README
+ *
+ * See license text in LICENSE file
+ */
+
+/**
+ * Include headers
+ *
+ * @ignore
+ */
+#include "./mysql_bindings_connection.h"
+#include "./mysql_bindings_pool.h"
+
+/**
+ * Init V8 structures for MysqlPool class
+ *
+ * @ignore
+ */
+Persistent<FunctionTemplate> MysqlPool::constructor_template;
+Persistent<Function> MysqlPool::on_connect;
+Persistent<Function> MysqlPool::on_reset;
+Persistent<Function> MysqlPool::query_acquired;
+Persistent<Function> MysqlPool::query_done;
+
+void MysqlPool::Init(Handle<Object> target) {
+    HandleScope scope;
+
+    Local<FunctionTemplate> t = FunctionTemplate::New(New);
+
+    // Constructor
+    constructor_template = Persistent<FunctionTemplate>::New(t);
+    constructor_template->Inherit(EventEmitter::constructor_template);
+    constructor_template->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor_template->SetClassName(String::NewSymbol("MysqlPool"));
+
+    // Methods
+    ADD_PROTOTYPE_METHOD(pool, acquire, Acquire);
+    ADD_PROTOTYPE_METHOD(pool, closeSync, CloseSync);
+    ADD_PROTOTYPE_METHOD(pool, query, Query);
+    ADD_PROTOTYPE_METHOD(pool, querySync, QuerySync);
+    ADD_PROTOTYPE_METHOD(pool, release, Release);
+    ADD_PROTOTYPE_METHOD(pool, setMaxSizeSync, SetMaxSizeSync);
+    ADD_PROTOTYPE_METHOD(pool, setSparesSync, SetSparesSync);
+    ADD_PROTOTYPE_METHOD(pool, statsSync, StatsSync);
+    ADD_PROTOTYPE_METHOD(pool, warmup, Warmup);
+
+    // Native callbacks, bound to per-call data on each call
+    on_connect = Persistent<Function>::New(
+        FunctionTemplate::New(OnConnect)->GetFunction());
+    on_reset = Persistent<Function>::New(
+        FunctionTemplate::New(OnReset)->GetFunction());
+    query_acquired = Persistent<Function>::New(
+        FunctionTemplate::New(QueryAcquired)->GetFunction());
+    query_done = Persistent<Function>::New(
+        FunctionTemplate::New(QueryDone)->GetFunction());
+
+    // Make it visible in JavaScript
+    target->Set(String::NewSymbol("MysqlPool"),
+                constructor_template->GetFunction());
+}
+
+MysqlPool::MysqlPool(): EventEmitter() {
+    idle = NULL;
+    idle_count = 0;
+    idle_capacity = 0;
+    waiters = NULL;
+    waiters_count = 0;
+    waiters_capacity = 0;
+    checked_out = NULL;
+    active = 0;
+    checked_out_capacity = 0;
+    connecting = 0;
+    resetting = 0;
+    spares = 0;
+    max_size = 0;
+    closed = false;
+}
+
+MysqlPool::~MysqlPool() {
+    // Idle connections are closed by their own destructors
+    for (uint32_t i = 0; i < idle_count; i++) {
+        idle[i].Dispose();
+    }
+    free(idle);
+    for (uint32_t i = 0; i < active; i++) {
+        checked_out[i].Dispose();
+    }
+    free(checked_out);
+    for (uint32_t i = 0; i < waiters_count; i++) {
+        waiters[i].Dispose();
+    }
+    free(waiters);
+    connect_args.Dispose();
+}
+
+/**
+ * Calls JavaScript method of object
+ *
+ * @ignore
+ */
+Local<Value> MysqlPool::CallMethod(Local<Object> js_obj, const char *name,
+                                   int argc, Local<Value> argv[]) {
+    HandleScope scope;
+
+    Local<Value> js_method = js_obj->Get(V8STR(name));
+    if (!js_method->IsFunction()) {
+        return scope.Close(Local<Value>::New(Undefined()));
+    }
+
+    return scope.Close(Local<Function>::Cast(js_method)->
+                                            Call(js_obj, argc, argv));
+}
+
+bool MysqlPool::PushIdle(Local<Object> js_conn) {
+    if (idle_count == idle_capacity) {
+        uint32_t new_capacity = idle_capacity ? 2*idle_capacity : 16;
+        Persistent<Object> *new_idle = reinterpret_cast<Persistent<Object> *>(
+            realloc(idle, new_capacity*sizeof(Persistent<Object>)));
+        if (!new_idle) {
+            return false;
+        }
+        idle = new_idle;
+        idle_capacity = new_capacity;
+    }
+
+    idle[idle_count++] = Persistent<Object>::New(js_conn);
+    return true;
+}
+
+Local<Object> MysqlPool::PopIdle() {
+    // Most recently used connection is the warmest one
+    Persistent<Object> js_conn = idle[--idle_count];
+    Local<Object> js_result = Local<Object>::New(js_conn);
+    js_conn.Dispose();
+    return js_result;
+}
+
+bool MysqlPool::CheckOut(Local<Object> js_conn) {
+    if (active == checked_out_capacity) {
+        uint32_t new_capacity =
+            checked_out_capacity ? 2*checked_out_capacity : 16;
+        Persistent<Object> *new_checked_out =
+            reinterpret_cast<Persistent<Object> *>(
+                realloc(checked_out, new_capacity*sizeof(Persistent<Object>)));
+        if (!new_checked_out) {
+            return false;
+        }
+        checked_out = new_checked_out;
+        checked_out_capacity = new_capacity;
+    }
+
+    checked_out[active++] = Persistent<Object>::New(js_conn);
+    return true;
+}
+
+/**
+ * Removes connection from handed out ones, false if it
+ * wasn't handed out by this pool or is already released
+ *
+ * @ignore
+ */
+bool MysqlPool::CheckIn(Local<Object> js_conn) {
+    for (uint32_t i = 0; i < active; i++) {
+        if (checked_out[i]->StrictEquals(js_conn)) {
+            checked_out[i].Dispose();
+            checked_out[i] = checked_out[--active];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool MysqlPool::PushWaiter(Local<Function> callback) {
+    if (waiters_count == waiters_capacity) {
+        uint32_t new_capacity = waiters_capacity ? 2*waiters_capacity : 16;
+        Persistent<Function> *new_waiters =
+            reinterpret_cast<Persistent<Function> *>(
+                realloc(waiters, new_capacity*sizeof(Persistent<Function>)));
+        if (!new_waiters) {
+            return false;
+        }
+        waiters = new_waiters;
+        waiters_capacity = new_capacity;
+    }
+
+    waiters[waiters_count++] = Persistent<Function>::New(callback);
+    return true;
+}
+
+Local<Function> MysqlPool::ShiftWaiter() {
+    Persistent<Function> callback = waiters[0];
+    Local<Function> js_result = Local<Function>::New(callback);
+    callback.Dispose();
+
+    waiters_count--;
+    memmove(waiters, waiters + 1, waiters_count*sizeof(Persistent<Function>));
+
+    return js_result;
+}
+
+uint32_t MysqlPool::TotalCount() {
+    return idle_count + active + connecting + resetting;
+}
+
+/**
+ * Creates connection and starts asynchronous connect in thread pool
+ *
+ * @ignore
+ */
+void MysqlPool::OpenConnection(struct warmup_data *warmup) {
+    HandleScope scope;
+
+    struct connect_data *data = new connect_data;
+    data->pool = this;
+    data->warmup = warmup;
+
+    Local<Object> js_conn =
+        MysqlConnection::constructor_template->GetFunction()->NewInstance();
+    data->conn = Persistent<Object>::New(js_conn);
+
+    Local<Value> argv[7];
+    for (int i = 0; i < 6; i++) {
+        argv[i] = connect_args->Get(Integer::New(i));
+    }
+    argv[6] = MysqlScheduler::BindCallback(on_connect, External::New(data));
+
+    connecting++;
+    Ref();
+
+    TryCatch try_catch;
+
+    CallMethod(js_conn, "connect", 7, argv);
+
+    if (try_catch.HasCaught()) {
+        ConnectDone(data, try_catch.Exception());
+    }
+}
+
+Handle<Value> MysqlPool::OnConnect(const Arguments& args) {
+    HandleScope scope;
+
+    struct connect_data *data = static_cast<struct connect_data *>(
+        Local<External>::Cast(args[0])->Value());
+
+    Local<Value> js_error = Local<Value>::New(Null());
+    if (args.Length() > 1 && !args[1]->IsNull()) {
+        Local<Object> js_conn = Local<Object>::New(data->conn);
+        Local<Value> js_message = js_conn->Get(V8STR("connectError"));
+        Local<Object> js_exception = Exception::Error(
+            js_message->IsString() ? js_message->ToString() :
+                                     V8STR("Connection error"))->ToObject();
+        js_exception->Set(V8STR("errno"), args[1]);
+        js_error = js_exception;
+    }
+
+    data->pool->ConnectDone(data, js_error);
+
+    return Undefined();
+}
+
+void MysqlPool::ConnectDone(struct connect_data *data, Local<Value> error) {
+    HandleScope scope;
+
+    Local<Object> js_conn = Local<Object>::New(data->conn);
+    struct warmup_data *warmup = data->warmup;
+
+    data->conn.Dispose();
+    delete data;
+
+    connecting--;
+
+    if (error->IsNull()) {
+        if (closed) {
+            CallMethod(js_conn, "closeSync", 0, NULL);
+        } else {
+            HandOut(js_conn);
+        }
+    } else if (!warmup && waiters_count) {
+        // Connection was opened for this waiter
+        Local<Value> argv[1];
+        argv[0] = error;
+        ShiftWaiter()->Call(Context::GetCurrent()->Global(), 1, argv);
+    }
+
+    if (warmup) {
+        if (error->IsNull()) {
+            warmup->opened++;
+        } else if (warmup->error.IsEmpty()) {
+            warmup->error = Persistent<Value>::New(error);
+        }
+
+        if (!--warmup->remaining) {
+            Local<Value> argv[2];
+            argv[0] = warmup->error.IsEmpty() ?
+                      Local<Value>::New(Null()) :
+                      Local<Value>::New(warmup->error);
+            argv[1] = Integer::NewFromUnsigned(warmup->opened);
+
+            Local<Function> callback = Local<Function>::New(warmup->callback);
+            warmup->callback.Dispose();
+            warmup->error.Dispose();
+            delete warmup;
+
+            callback->Call(Context::GetCurrent()->Global(), 2, argv);
+        }
+    }
+
+    Unref();
+}
+
+/**
+ * Gives connection to first waiter or puts it into idle list
+ *
+ * @ignore
+ */
+void MysqlPool::HandOut(Local<Object> js_conn) {
+    if (waiters_count) {
+        Local<Function> callback = ShiftWaiter();
+        Local<Value> argv[2];
+
+        if (!CheckOut(js_conn)) {
+            CallMethod(js_conn, "closeSync", 0, NULL);
+            argv[0] = V8EXC("Could not allocate enough memory");
+            callback->Call(Context::GetCurrent()->Global(), 1, argv);
+            return;
+        }
+
+        argv[0] = Local<Value>::New(Null());
+        argv[1] = js_conn;
+        callback->Call(Context::GetCurrent()->Global(), 2, argv);
+    } else if (!PushIdle(js_conn)) {
+        CallMethod(js_conn, "closeSync", 0, NULL);
+    }
+}
+
+/**
+ * Opens connections in background until there are enough spares
+ * and connections for all waiters
+ *
+ * @ignore
+ */
+void MysqlPool::Replenish() {
+    if (closed) {
+        return;
+    }
+
+    uint32_t needed = spares + waiters_count;
+
+    while (idle_count + connecting + resetting < needed &&
+           (!max_size || TotalCount() < max_size)) {
+        OpenConnection(NULL);
+    }
+}
+
+void MysqlPool::AcquireConnection(Local<Function> callback) {
+    HandleScope scope;
+
+    while (idle_count) {
+        Local<Object> js_conn = PopIdle();
+
+        // Skip connections found dead by keepalive
+        if (!CallMethod(js_conn, "connectedSync", 0, NULL)->BooleanValue()) {
+            CallMethod(js_conn, "closeSync", 0, NULL);
+            continue;
+        }
+
+        if (!CheckOut(js_conn)) {
+            PushIdle(js_conn);
+            break;
+        }
+        Replenish();
+
+        Local<Value> argv[2];
+        argv[0] = Local<Value>::New(Null());
+        argv[1] = js_conn;
+        callback->Call(Context::GetCurrent()->Global(), 2, argv);
+        return;
+    }
+
+    if (!PushWaiter(callback)) {
+        Local<Value> argv[1];
+        argv[0] = V8EXC("Could not allocate enough memory");
+        callback->Call(Context::GetCurrent()->Global(), 1, argv);
+        return;
+    }
+
+    Replenish();
+}
+
+/**
+ * Starts lazy session reset, connection returns to idle list
+ * when reset is finished. False if connection is not handed out
+ *
+ * @ignore
+ */
+bool MysqlPool::ReleaseConnection(Local<Object> js_conn) {
+    HandleScope scope;
+
+    if (!CheckIn(js_conn)) {
+        return false;
+    }
+
+    if (closed) {
+        CallMethod(js_conn, "closeSync", 0, NULL);
+        return true;
+    }
+
+    struct release_data *data = new release_data;
+    data->pool = this;
+    data->conn = Persistent<Object>::New(js_conn);
+
+    resetting++;
+    Ref();
+
+    Local<Value> argv[1];
+    argv[0] = MysqlScheduler::BindCallback(on_reset, External::New(data));
+
+    TryCatch try_catch;
+
+    CallMethod(js_conn, "reset", 1, argv);
+
+    if (try_catch.HasCaught()) {
+        // Connection is closed or broken, drop it
+        resetting--;
+        data->conn.Dispose();
+        delete data;
+        Unref();
+        Replenish();
+    }
+
+    return true;
+}
+
+Handle<Value> MysqlPool::OnReset(const Arguments& args) {
+    HandleScope scope;
+
+    struct release_data *data = static_cast<struct release_data *>(
+        Local<External>::Cast(args[0])->Value());
+    MysqlPool *pool = data->pool;
+
+    Local<Object> js_conn = Local<Object>::New(data->conn);
+    data->conn.Dispose();
+    delete data;
+
+    pool->resetting--;
+
+    if (args.Length() > 1 && !args[1]->IsNull()) {
+        CallMethod(js_conn, "closeSync", 0, NULL);
+        pool->Replenish();
+    } else if (pool->closed) {
+        CallMethod(js_conn, "closeSync", 0, NULL);
+    } else {
+        pool->HandOut(js_conn);
+    }
+
+    pool->Unref();
+
+    return Undefined();
+}
+
+/**
+ * Creates new MysqlPool object, connections are opened with
+ * the same arguments as MysqlConnection.connect()
+ *
+ * @constructor
+ * @param {String|null} hostname
+ * @param {String|null} user
+ * @param {String|null} password
+ * @param {String|null} database
+ * @param {Integer|null} port
+ * @param {String|null} socket
+ */
+Handle<Value> MysqlPool::New(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlPool *pool = new MysqlPool();
+
+    Local<Array> js_args = Array::New(6);
+    for (int i = 0; i < 6; i++) {
+        js_args->Set(Integer::New(i), i < args.Length() ?
+                     args[i] : Local<Value>::New(Null()));
+    }
+    pool->connect_args = Persistent<Array>::New(js_args);
+
+    pool->Wrap(args.This());
+
+    return args.This();
+}
+
+/**
+ * Gets connection from pool, opens new one if there are no idle
+ * connections. Callback is called immediately if idle connection exists
+ *
+ * @param {Function(error, connection)} callback
+ */
+Handle<Value> MysqlPool::Acquire(const Arguments& args) {
+    HandleScope scope;
+
+    REQ_FUN_ARG(0, callback);
+
+    MysqlPool *pool = OBJUNWRAP<MysqlPool>(args.This());
+
+    if (pool->closed) {
+        return THREXC("Pool is closed");
+    }
+
+    pool->AcquireConnection(callback);
+
+    return Undefined();
+}
+
+/**
+ * Closes idle connections, connections in use are closed on release
+ */
+Handle<Value> MysqlPool::CloseSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlPool *pool = OBJUNWRAP<MysqlPool>(args.This());
+
+    pool->closed = true;
+
+    while (pool->idle_count) {
+        CallMethod(pool->PopIdle(), "closeSync", 0, NULL);
+    }
+
+    while (pool->waiters_count) {
+        Local<Value> argv[1];
+        argv[0] = V8EXC("Pool is closed");
+        pool->ShiftWaiter()->Call(Context::GetCurrent()->Global(), 1, argv);
+    }
+
+    return Undefined();
+}
+
+Handle<Value> MysqlPool::QueryAcquired(const Arguments& args) {
+    HandleScope scope;
+
+    struct query_data *data = static_cast<struct query_data *>(
+        Local<External>::Cast(args[0])->Value());
+
+    Local<Value> argv[2];
+
+    if (args.Length() < 3 || !args[1]->IsNull()) {
+        argv[0] = args.Length() > 1 ? args[1] : V8EXC("Pool error");
+        Local<Function> callback = Local<Function>::New(data->callback);
+        data->callback.Dispose();
+        data->query.Dispose();
+        delete data;
+        return scope.Close(callback->Call(Context::GetCurrent()->Global(),
+                                          1, argv));
+    }
+
+    Local<Object> js_conn = args[2]->ToObject();
+    data->conn = Persistent<Object>::New(js_conn);
+
+    argv[0] = Local<Value>::New(data->query);
+    argv[1] = MysqlScheduler::BindCallback(query_done, External::New(data));
+
+    TryCatch try_catch;
+
+    CallMethod(js_conn, "query", 2, argv);
+
+    if (try_catch.HasCaught()) {
+        Local<Value> js_exception = try_catch.Exception();
+        Local<Value> done_argv[1];
+        done_argv[0] = js_exception;
+        return scope.Close(FinishQuery(data, done_argv, 1));
+    }
+
+    return Undefined();
+}
+
+Handle<Value> MysqlPool::QueryDone(const Arguments& args) {
+    HandleScope scope;
+
+    struct query_data *data = static_cast<struct query_data *>(
+        Local<External>::Cast(args[0])->Value());
+
+    Local<Value> argv[2];
+    int argc = args.Length() - 1 < 2 ? args.Length() - 1 : 2;
+    for (int i = 0; i < argc; i++) {
+        argv[i] = args[i + 1];
+    }
+
+    return scope.Close(FinishQuery(data, argv, argc));
+}
+
+/**
+ * Releases connection and calls query callback
+ *
+ * @ignore
+ */
+Handle<Value> MysqlPool::FinishQuery(struct query_data *data,
+                                     Local<Value> argv[], int argc) {
+    HandleScope scope;
+
+    Local<Function> callback = Local<Function>::New(data->callback);
+
+    data->pool->ReleaseConnection(Local<Object>::New(data->conn));
+
+    data->conn.Dispose();
+    data->query.Dispose();
+    data->callback.Dispose();
+    delete data;
+
+    return scope.Close(callback->Call(Context::GetCurrent()->Global(),
+                                      argc, argv));
+}
+
+/**
+ * Performs query asynchronously on pooled connection, connection
+ * is released when query is finished
+ *
+ * @param {String} query
+ * @param {Function(error, result)} callback
+ */
+Handle<Value> MysqlPool::Query(const Arguments& args) {
+    HandleScope scope;
+
+    REQ_STR_ARG(0, query);
+    REQ_FUN_ARG(1, callback);
+
+    MysqlPool *pool = OBJUNWRAP<MysqlPool>(args.This());
+
+    if (pool->closed) {
+        return THREXC("Pool is closed");
+    }
+
+    struct query_data *data = new query_data;
+    data->pool = pool;
+    data->query = Persistent<Value>::New(args[0]);
+    data->callback = Persistent<Function>::New(callback);
+
+    pool->AcquireConnection(
+        MysqlScheduler::BindCallback(query_acquired, External::New(data)));
+
+    return Undefined();
+}
+
+/**
+ * Performs query synchronously on idle connection, or on new one
+ * if there are no idle connections, throws if pool is at max size
+ *
+ * @param {String} query
+ * @return {MysqlResult|Boolean}
+ */
+Handle<Value> MysqlPool::QuerySync(const Arguments& args) {
+    HandleScope scope;
+
+    REQ_STR_ARG(0, query);
+
+    MysqlPool *pool = OBJUNWRAP<MysqlPool>(args.This());
+
+    if (pool->closed) {
+        return THREXC("Pool is closed");
+    }
+
+    Local<Object> js_conn;
+    while (pool->idle_count) {
+        js_conn = pool->PopIdle();
+        if (CallMethod(js_conn, "connectedSync", 0, NULL)->BooleanValue()) {
+            break;
+        }
+        CallMethod(js_conn, "closeSync", 0, NULL);
+        js_conn.Clear();
+    }
+
+    if (js_conn.IsEmpty()) {
+        if (pool->max_size && pool->TotalCount() >= pool->max_size) {
+            return THREXC("No idle connections and pool is at max size");
+        }
+
+        js_conn =
+            MysqlConnection::constructor_template->GetFunction()->NewInstance();
+
+        Local<Value> connect_argv[6];
+        for (int i = 0; i < 6; i++) {
+            connect_argv[i] = pool->connect_args->Get(Integer::New(i));
+        }
+        CallMethod(js_conn, "connectSync", 6, connect_argv);
+
+        if (!CallMethod(js_conn, "connectedSync", 0, NULL)->BooleanValue()) {
+            Local<Value> js_message = js_conn->Get(V8STR("connectError"));
+            return ThrowException(Exception::Error(
+                js_message->IsString() ? js_message->ToString() :
+                                         V8STR("Connection error")));
+        }
+    }
+
+    if (!pool->CheckOut(js_conn)) {
+        CallMethod(js_conn, "closeSync", 0, NULL);
+        return THREXC("Could not allocate enough memory");
+    }
+
+    Local<Value> argv[1];
+    argv[0] = args[0];
+
+    TryCatch try_catch;
+
+    Local<Value> js_result = CallMethod(js_conn, "querySync", 1, argv);
+
+    pool->ReleaseConnection(js_conn);
+
+    if (try_catch.HasCaught()) {
+        return ThrowException(try_catch.Exception());
+    }
+
+    return scope.Close(js_result);
+}
+
+/**
+ * Returns connection to pool, its session is reset in background
+ * before it is handed out again. Throws for connection which is
+ * not acquired from this pool or is already released
+ *
+ * @param {MysqlConnection} connection
+ */
+Handle<Value> MysqlPool::Release(const Arguments& args) {
+    HandleScope scope;
+
+    if (args.Length() < 1 ||
+        !MysqlConnection::constructor_template->HasInstance(args[0])) {
+        return THRTYPEEXC("Argument 0 must be a MysqlConnection");
+    }
+
+    MysqlPool *pool = OBJUNWRAP<MysqlPool>(args.This());
+
+    if (!pool->ReleaseConnection(args[0]->ToObject())) {
+        return THREXC("Connection is not acquired from this pool "
+                      "or is already released");
+    }
+
+    return Undefined();
+}
+
+/**
+ * Sets maximum number of connections, 0 means unlimited
+ *
+ * @param {Integer} size
+ * @return {Boolean}
+ */
+Handle<Value> MysqlPool::SetMaxSizeSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlPool *pool = OBJUNWRAP<MysqlPool>(args.This());
+
+    REQ_UINT_ARG(0, size)
+
+    pool->max_size = size;
+
+    return scope.Close(True());
+}
+
+/**
+ * Sets number of pre-authenticated idle connections kept ready,
+ * missing ones are opened in background
+ *
+ * @param {Integer} spares
+ * @return {Boolean}
+ */
+Handle<Value> MysqlPool::SetSparesSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlPool *pool = OBJUNWRAP<MysqlPool>(args.This());
+
+    REQ_UINT_ARG(0, spares)
+
+    pool->spares = spares;
+    pool->Replenish();
+
+    return scope.Close(True());
+}
+
+/**
+ * Returns pool gauges
+ *
+ * @return {Object} idle, active, connecting, resetting and waiting counts
+ */
+Handle<Value> MysqlPool::StatsSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlPool *pool = OBJUNWRAP<MysqlPool>(args.This());
+
+    Local<Object> js_stats = Object::New();
+    js_stats->Set(V8STR("idle"), Integer::NewFromUnsigned(pool->idle_count));
+    js_stats->Set(V8STR("active"), Integer::NewFromUnsigned(pool->active));
+    js_stats->Set(V8STR("connecting"),
+                  Integer::NewFromUnsigned(pool->connecting));
+    js_stats->Set(V8STR("resetting"),
+                  Integer::NewFromUnsigned(pool->resetting));
+    js_stats->Set(V8STR("waiting"),
+                  Integer::NewFromUnsigned(pool->waiters_count));
+
+    return scope.Close(js_stats);
+}
+
+/**
+ * Opens connections in parallel through the thread pool
+ *
+ * @param {Integer} count
+ * @param {Function(error, opened)} callback
+ */
+Handle<Value> MysqlPool::Warmup(const Arguments& args) {
+    HandleScope scope;
+
+    REQ_UINT_ARG(0, count)
+    REQ_FUN_ARG(1, callback);
+
+    MysqlPool *pool = OBJUNWRAP<MysqlPool>(args.This());
+
+    if (pool->closed) {
+        return THREXC("Pool is closed");
+    }
+
+    if (pool->max_size && pool->TotalCount() + count > pool->max_size) {
+        count = pool->max_size > pool->TotalCount() ?
+                pool->max_size - pool->TotalCount() : 0;
+    }
+
+    if (!count) {
+        Local<Value> argv[2];
+        argv[0] = Local<Value>::New(Null());
+        argv[1] = Integer::New(0);
+        callback->Call(Context::GetCurrent()->Global(), 2, argv);
+        return Undefined();
+    }
+
+    struct warmup_data *warmup = new warmup_data;
+    warmup->callback = Persistent<Function>::New(callback);
+    warmup->remaining = count;
+    warmup->opened = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        pool->OpenConnection(warmup);
+    }
+
+    return Undefined();
+}
+
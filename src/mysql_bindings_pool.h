@@ -0,0 +1,159 @@
+/*
+Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+See contributors list in README
+
+See license text in LICENSE file
+*/
+
+#ifndef NODE_MYSQL_POOL_H  // NOLINT
+#define NODE_MYSQL_POOL_H
+
+#include <v8.h>
+#include <node.h>
+#include <node_events.h>
+
+#include "./mysql_bindings.h"
+
+static Persistent<String> pool_acquire_symbol;
+static Persistent<String> pool_closeSync_symbol;
+static Persistent<String> pool_query_symbol;
+static Persistent<String> pool_querySync_symbol;
+static Persistent<String> pool_release_symbol;
+static Persistent<String> pool_setMaxSizeSync_symbol;
+static Persistent<String> pool_setSparesSync_symbol;
+static Persistent<String> pool_statsSync_symbol;
+static Persistent<String> pool_warmup_symbol;
+
+class MysqlPool : public node::EventEmitter {
+  public:
+    static Persistent<FunctionTemplate> constructor_template;
+
+    static void Init(Handle<Object> target);
+
+  protected:
+    // hostname, user, password, database, port and socket
+    // passed to MysqlConnection.connect()
+    Persistent<Array> connect_args;
+
+    // Connected and reset connections ready to be handed out
+    Persistent<Object> *idle;
+    uint32_t idle_count;
+    uint32_t idle_capacity;
+
+    // Callbacks waiting for connection, FIFO
+    Persistent<Function> *waiters;
+    uint32_t waiters_count;
+    uint32_t waiters_capacity;
+
+    // Connections handed out and not released yet
+    Persistent<Object> *checked_out;
+    uint32_t active;
+    uint32_t checked_out_capacity;
+
+    uint32_t connecting;
+    uint32_t resetting;
+
+    uint32_t spares;
+    uint32_t max_size;
+
+    bool closed;
+
+    MysqlPool();
+
+    ~MysqlPool();
+
+    struct warmup_data {
+        Persistent<Function> callback;
+        uint32_t remaining;
+        uint32_t opened;
+        Persistent<Value> error;
+    };
+
+    struct connect_data {
+        MysqlPool *pool;
+        Persistent<Object> conn;
+        struct warmup_data *warmup;
+    };
+
+    struct release_data {
+        MysqlPool *pool;
+        Persistent<Object> conn;
+    };
+
+    struct query_data {
+        MysqlPool *pool;
+        Persistent<Object> conn;
+        Persistent<Value> query;
+        Persistent<Function> callback;
+    };
+
+    static Local<Value> CallMethod(Local<Object> js_obj, const char *name,
+                                   int argc, Local<Value> argv[]);
+
+    bool PushIdle(Local<Object> js_conn);
+
+    Local<Object> PopIdle();
+
+    bool CheckOut(Local<Object> js_conn);
+
+    bool CheckIn(Local<Object> js_conn);
+
+    bool PushWaiter(Local<Function> callback);
+
+    Local<Function> ShiftWaiter();
+
+    uint32_t TotalCount();
+
+    void OpenConnection(struct warmup_data *warmup);
+
+    void ConnectDone(struct connect_data *data, Local<Value> error);
+
+    void HandOut(Local<Object> js_conn);
+
+    void AcquireConnection(Local<Function> callback);
+
+    bool ReleaseConnection(Local<Object> js_conn);
+
+    void Replenish();
+
+    // Native callbacks, bound to per-call data on each call
+    static Persistent<Function> on_connect;
+    static Persistent<Function> on_reset;
+    static Persistent<Function> query_acquired;
+    static Persistent<Function> query_done;
+
+    static Handle<Value> OnConnect(const Arguments& args);
+
+    static Handle<Value> OnReset(const Arguments& args);
+
+    // Constructor
+
+    static Handle<Value> New(const Arguments& args);
+
+    // Methods
+
+    static Handle<Value> Acquire(const Arguments& args);
+
+    static Handle<Value> CloseSync(const Arguments& args);
+
+    static Handle<Value> QueryAcquired(const Arguments& args);
+    static Handle<Value> QueryDone(const Arguments& args);
+    static Handle<Value> FinishQuery(struct query_data *data,
+                                     Local<Value> argv[], int argc);
+    static Handle<Value> Query(const Arguments& args);
+
+    static Handle<Value> QuerySync(const Arguments& args);
+
+    static Handle<Value> Release(const Arguments& args);
+
+    static Handle<Value> SetMaxSizeSync(const Arguments& args);
+
+    static Handle<Value> SetSparesSync(const Arguments& args);
+
+    static Handle<Value> StatsSync(const Arguments& args);
+
+    static Handle<Value> Warmup(const Arguments& args);
+};
+
+#endif  // NODE_MYSQL_POOL_H  // NOLINT
+
@@ -51,13 +51,23 @@ void MysqlResult::Init(Handle<Object> target) {
     ADD_PROTOTYPE_METHOD(result, fieldTellSync, FieldTellSync);
     ADD_PROTOTYPE_METHOD(result, freeSync, FreeSync);
     ADD_PROTOTYPE_METHOD(result, numRowsSync, NumRowsSync);
+    ADD_PROTOTYPE_METHOD(result, serialize, Serialize);
+
+    // Static methods
+    Local<Function> js_constructor = constructor_template->GetFunction();
+    js_constructor->Set(V8STR("deserializeSync"),
+        FunctionTemplate::New(DeserializeSync)->GetFunction());
 
     // Make it visible in JavaScript
-    target->Set(String::NewSymbol("MysqlResult"),
-                constructor_template->GetFunction());
+    target->Set(String::NewSymbol("MysqlResult"), js_constructor);
 }
 
-MysqlResult::MysqlResult(): EventEmitter() {}
+MysqlResult::MysqlResult(): EventEmitter(),
+                            _res(NULL),
+                            field_count(0),
+                            _serialized(NULL),
+                            serializing(0),
+                            priority(EIO_PRI_DEFAULT) {}
 
 MysqlResult::~MysqlResult() {
     this->Free();
@@ -82,7 +92,89 @@ void MysqlResult::AddFieldProperties(
     js_field_obj->Set(V8STR("decimals"), Integer::New(field->decimals));
 }
 
-Local<Value> MysqlResult::GetFieldValue(MYSQL_FIELD field, char* field_value) {
+/**
+ * Creates string from field value without strlen(), latin1 and ascii
+ * values with non-ASCII bytes are widened without UTF-8 decoding
+ *
+ * @ignore
+ */
+Local<String> MysqlResult::GetFieldString(MYSQL_FIELD field,
+                                          const char *field_value,
+                                          unsigned long field_length) {  // NOLINT
+    HandleScope scope;
+
+    // MySQL latin1 is cp1252, it differs from Unicode in 0x80-0x9F only,
+    // bytes undefined in cp1252 are kept as C1 controls like MySQL does
+    static const uint16_t cp1252_c1[32] = {
+        0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+        0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+        0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+        0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178
+    };
+    bool single_byte = false;
+    bool cp1252 = false;
+
+    switch (field.charsetnr) {
+        case 5:  // latin1_german1_ci
+        case 8:  // latin1_swedish_ci
+        case 15:  // latin1_danish_ci
+        case 31:  // latin1_german2_ci
+        case 47:  // latin1_bin
+        case 48:  // latin1_general_ci
+        case 49:  // latin1_general_cs
+        case 94:  // latin1_spanish_ci
+            cp1252 = true;
+            single_byte = true;
+            break;
+        case 11:  // ascii_general_ci
+        case 65:  // ascii_bin
+            single_byte = true;
+            break;
+    }
+
+    if (single_byte) {
+        unsigned long i = 0;  // NOLINT
+        while (i < field_length &&
+               !(static_cast<unsigned char>(field_value[i]) & 0x80)) {
+            i++;
+        }
+
+        if (i < field_length) {
+            // Other bytes are Unicode code points, just widen them
+            uint16_t stack_buffer[256];
+            uint16_t *buffer = stack_buffer;
+
+            if (field_length > 256) {
+                buffer = reinterpret_cast<uint16_t *>(
+                    malloc(field_length*sizeof(uint16_t)));
+                if (!buffer) {
+                    V8::LowMemoryNotification();
+                    return scope.Close(String::New(field_value, field_length));
+                }
+            }
+
+            for (i = 0; i < field_length; i++) {
+                unsigned char c = static_cast<unsigned char>(field_value[i]);
+                buffer[i] = cp1252 && c >= 0x80 && c < 0xA0 ?
+                            cp1252_c1[c - 0x80] : c;
+            }
+
+            Local<String> js_string = String::New(buffer, field_length);
+
+            if (buffer != stack_buffer) {
+                free(buffer);
+            }
+
+            return scope.Close(js_string);
+        }
+    }
+
+    // UTF-8 and pure ASCII values, String::New() decodes them as UTF-8
+    return scope.Close(String::New(field_value, field_length));
+}
+
+Local<Value> MysqlResult::GetFieldValue(MYSQL_FIELD field, char* field_value,
+                                        unsigned long field_length) {  // NOLINT
     HandleScope scope;
 
     Local<Value> js_field = Local<Value>::New(Null());
@@ -194,7 +286,7 @@ Local<Value> MysqlResult::GetFieldValue(MYSQL_FIELD field, char* field_value) {
         case MYSQL_TYPE_VAR_STRING:
         case MYSQL_TYPE_VARCHAR:
             if (field_value) {
-                js_field = V8STR(field_value);
+                js_field = GetFieldString(field, field_value, field_length);
             }
             break;
         case MYSQL_TYPE_SET:  // SET field
@@ -216,7 +308,7 @@ Local<Value> MysqlResult::GetFieldValue(MYSQL_FIELD field, char* field_value) {
             break;
         case MYSQL_TYPE_ENUM:  // ENUM field
             if (field_value) {
-                js_field = V8STR(field_value);
+                js_field = GetFieldString(field, field_value, field_length);
             }
             break;
         case MYSQL_TYPE_GEOMETRY:  // Spatial fielda
@@ -228,7 +320,7 @@ Local<Value> MysqlResult::GetFieldValue(MYSQL_FIELD field, char* field_value) {
             break;
         default:
             if (field_value) {
-                js_field = V8STR(field_value);
+                js_field = GetFieldString(field, field_value, field_length);
             }
     }
 
@@ -252,11 +344,536 @@ Local<Value> MysqlResult::GetFieldValue(MYSQL_FIELD field, char* field_value) {
     return scope.Close(js_field);
 }
 
+/**
+ * Converts all rows of stored result to array of objects,
+ * like fetchAllSync() does
+ *
+ * @ignore
+ */
+Local<Array> MysqlResult::RowsToArray(MYSQL_RES *my_result) {
+    HandleScope scope;
+
+    MYSQL_FIELD *fields = mysql_fetch_fields(my_result);
+    uint32_t num_fields = mysql_num_fields(my_result);
+    MYSQL_ROW result_row;
+    uint32_t i = 0, j = 0;
+
+    Local<Array> js_result = Array::New();
+
+    mysql_data_seek(my_result, 0);
+
+    while ( (result_row = mysql_fetch_row(my_result)) ) {
+        unsigned long *result_lengths = mysql_fetch_lengths(my_result);  // NOLINT
+        Local<Object> js_result_row = Object::New();
+
+        for (j = 0; j < num_fields; j++) {
+            js_result_row->Set(V8STR(fields[j].name),
+                               GetFieldValue(fields[j], result_row[j],
+                                             result_lengths[j]));
+        }
+
+        js_result->Set(Integer::New(i), js_result_row);
+
+        i++;
+    }
+
+    return scope.Close(js_result);
+}
+
 void MysqlResult::Free() {
     if (_res) {
         mysql_free_result(_res);
         _res = NULL;
     }
+    if (_serialized) {
+        FreeSerialized(_serialized);
+        _serialized = NULL;
+    }
+}
+
+MYSQL_FIELD *MysqlResult::FetchFields() {
+    return _serialized ? _serialized->fields : mysql_fetch_fields(_res);
+}
+
+uint32_t MysqlResult::NumFields() {
+    return _serialized ? _serialized->num_fields : mysql_num_fields(_res);
+}
+
+my_ulonglong MysqlResult::NumRows() {
+    return _serialized ? _serialized->num_rows : mysql_num_rows(_res);
+}
+
+void MysqlResult::DataSeek(my_ulonglong offset) {
+    if (!_serialized) {
+        mysql_data_seek(_res, offset);
+        return;
+    }
+
+    _serialized->current_row = offset;
+    _serialized->lengths_row = -1;
+}
+
+MYSQL_ROW MysqlResult::FetchRow() {
+    if (!_serialized) {
+        return mysql_fetch_row(_res);
+    }
+
+    if (_serialized->current_row >= _serialized->num_rows) {
+        _serialized->lengths_row = -1;
+        return NULL;
+    }
+
+    _serialized->lengths_row = _serialized->current_row++;
+
+    return _serialized->values +
+           _serialized->lengths_row*_serialized->num_fields;
+}
+
+unsigned long *MysqlResult::FetchLengths() {  // NOLINT
+    if (!_serialized) {
+        return mysql_fetch_lengths(_res);
+    }
+
+    if (_serialized->lengths_row < 0) {
+        return NULL;
+    }
+
+    return _serialized->lengths +
+           _serialized->lengths_row*_serialized->num_fields;
+}
+
+MYSQL_FIELD *MysqlResult::FetchField() {
+    if (!_serialized) {
+        return mysql_fetch_field(_res);
+    }
+
+    if (_serialized->current_field >= _serialized->num_fields) {
+        return NULL;
+    }
+
+    return &_serialized->fields[_serialized->current_field++];
+}
+
+MYSQL_FIELD *MysqlResult::FetchFieldDirect(uint32_t field_num) {
+    if (!_serialized) {
+        return mysql_fetch_field_direct(_res, field_num);
+    }
+
+    return field_num < _serialized->num_fields ?
+           &_serialized->fields[field_num] : NULL;
+}
+
+void MysqlResult::FieldSeek(MYSQL_FIELD_OFFSET offset) {
+    if (!_serialized) {
+        mysql_field_seek(_res, offset);
+        return;
+    }
+
+    _serialized->current_field = offset;
+}
+
+MYSQL_FIELD_OFFSET MysqlResult::FieldTell() {
+    return _serialized ? _serialized->current_field : mysql_field_tell(_res);
+}
+
+bool MysqlResult::IsUnbuffered() {
+    return !_serialized && mysql_result_is_unbuffered(_res);
+}
+
+void MysqlResult::PutUint32(unsigned char *to, uint32_t value) {
+    // Little-endian on any host
+    to[0] = value & 0xFF;
+    to[1] = (value >> 8) & 0xFF;
+    to[2] = (value >> 16) & 0xFF;
+    to[3] = (value >> 24) & 0xFF;
+}
+
+uint32_t MysqlResult::GetUint32(const unsigned char *from) {
+    return static_cast<uint32_t>(from[0]) |
+           static_cast<uint32_t>(from[1]) << 8 |
+           static_cast<uint32_t>(from[2]) << 16 |
+           static_cast<uint32_t>(from[3]) << 24;
+}
+
+/**
+ * Collects row pointers and lengths in main thread, so worker
+ * doesn't move result cursor, which JS code may use meanwhile.
+ * Rows memory stays valid until result is freed
+ *
+ * @ignore
+ */
+const char *MysqlResult::Snapshot(struct rows_snapshot *snapshot) {
+    uint32_t num_fields = NumFields();
+    uint64_t num_rows = NumRows();
+
+    snapshot->fields = FetchFields();
+    snapshot->num_fields = num_fields;
+    snapshot->rows = NULL;
+    snapshot->lengths = NULL;
+
+    size_t max_cells = static_cast<size_t>(-1)/sizeof(snapshot->lengths[0]) - 1;
+    if (num_rows <= max_cells/(num_fields ? num_fields : 1)) {
+        snapshot->rows = reinterpret_cast<MYSQL_ROW *>(
+            calloc(num_rows + 1, sizeof(MYSQL_ROW)));
+        snapshot->lengths = reinterpret_cast<unsigned long *>(  // NOLINT
+            calloc(num_rows*num_fields + 1, sizeof(unsigned long)));  // NOLINT
+    }
+
+    if (!snapshot->rows || !snapshot->lengths) {
+        FreeSnapshot(snapshot);
+        return "Could not allocate enough memory";
+    }
+
+    // Cursor is restored, so it's the same for JS code
+    MYSQL_ROW_OFFSET saved_offset = NULL;
+    uint64_t saved_row = 0;
+    if (_serialized) {
+        saved_row = _serialized->current_row;
+    } else {
+        saved_offset = mysql_row_tell(_res);
+    }
+
+    MYSQL_ROW row;
+    uint64_t i;
+
+    DataSeek(0);
+    for (i = 0; i < num_rows && (row = FetchRow()); i++) {
+        snapshot->rows[i] = row;
+        memcpy(snapshot->lengths + i*num_fields, FetchLengths(),
+               num_fields*sizeof(unsigned long));  // NOLINT
+    }
+    snapshot->num_rows = i;
+
+    if (_serialized) {
+        _serialized->current_row = saved_row;
+        _serialized->lengths_row = -1;
+    } else {
+        mysql_row_seek(_res, saved_offset);
+    }
+
+    return NULL;
+}
+
+void MysqlResult::FreeSnapshot(struct rows_snapshot *snapshot) {
+    free(snapshot->rows);
+    free(snapshot->lengths);
+    snapshot->rows = NULL;
+    snapshot->lengths = NULL;
+}
+
+/**
+ * Encodes fields and all rows for serialize(). After the header
+ * (magic, version, fields and rows count) go fields, then values
+ * by columns: NULL bitmap, lengths and data of each column
+ *
+ * @ignore
+ */
+const char *MysqlResult::Encode(const struct rows_snapshot *snapshot,
+                                char **data, size_t *length) {
+    MYSQL_FIELD *fields = snapshot->fields;
+    uint32_t num_fields = snapshot->num_fields;
+    uint64_t num_rows = snapshot->num_rows;
+    size_t bitmap_length = (num_rows + 7)/8;
+    const char *error = NULL;
+    uint64_t i;
+    uint32_t j, k;
+
+    // Data length and then write position of each column
+    uint64_t *column_lengths = reinterpret_cast<uint64_t *>(
+        calloc(2*num_fields + 1, sizeof(uint64_t)));
+
+    if (!column_lengths) {
+        return "Could not allocate enough memory";
+    }
+
+    uint64_t *column_starts = column_lengths + num_fields;
+
+    uint64_t size = SERIALIZED_RESULT_HEADER_LENGTH;
+    for (j = 0; j < num_fields; j++) {
+        const char *strings[6] = {fields[j].name, fields[j].org_name,
+                                  fields[j].table, fields[j].org_table,
+                                  fields[j].db, fields[j].def};
+        size += 6*4;
+        for (k = 0; k < 6; k++) {
+            size += 4 + (strings[k] ? strlen(strings[k]) : 0);
+        }
+    }
+
+    for (i = 0; i < num_rows; i++) {
+        MYSQL_ROW row = snapshot->rows[i];
+        unsigned long *lengths = snapshot->lengths + i*num_fields;  // NOLINT
+        for (j = 0; j < num_fields; j++) {
+            if (!row[j]) {
+                continue;
+            }
+            if (static_cast<uint64_t>(lengths[j]) > 0xFFFFFFFFULL) {
+                error = "Value is too long to serialize";
+            }
+            column_lengths[j] += lengths[j];
+        }
+    }
+
+    for (j = 0; j < num_fields; j++) {
+        column_starts[j] = size + bitmap_length + 4*num_rows;
+        size += bitmap_length + 4*num_rows + column_lengths[j];
+        column_lengths[j] = 0;
+    }
+
+    unsigned char *out = NULL;
+    if (!error && size == static_cast<size_t>(size)) {
+        // Zeroed, so NULL bitmaps need only set bits
+        out = reinterpret_cast<unsigned char *>(calloc(size, 1));
+    }
+    if (!error && !out) {
+        error = "Could not allocate enough memory";
+    }
+
+    if (!error) {
+        unsigned char *p = out;
+
+        memcpy(p, SERIALIZED_RESULT_MAGIC, 4);
+        p[4] = SERIALIZED_RESULT_VERSION;
+        PutUint32(p + 8, num_fields);
+        PutUint32(p + 12, num_rows & 0xFFFFFFFFULL);
+        PutUint32(p + 16, num_rows >> 32);
+        p += SERIALIZED_RESULT_HEADER_LENGTH;
+
+        for (j = 0; j < num_fields; j++) {
+            const char *strings[6] = {fields[j].name, fields[j].org_name,
+                                      fields[j].table, fields[j].org_table,
+                                      fields[j].db, fields[j].def};
+            PutUint32(p, fields[j].type);
+            PutUint32(p + 4, fields[j].flags);
+            PutUint32(p + 8, fields[j].decimals);
+            PutUint32(p + 12, fields[j].charsetnr);
+            PutUint32(p + 16, fields[j].length);
+            PutUint32(p + 20, fields[j].max_length);
+            p += 6*4;
+
+            for (k = 0; k < 6; k++) {
+                // Decode() accepts NULL for default value only
+                if (!strings[k] && k == 5) {
+                    PutUint32(p, 0xFFFFFFFFU);
+                    p += 4;
+                    continue;
+                }
+                const char *string = strings[k] ? strings[k] : "";
+                size_t string_length = strlen(string);
+                PutUint32(p, string_length);
+                memcpy(p + 4, string, string_length);
+                p += 4 + string_length;
+            }
+        }
+
+        for (i = 0; i < num_rows; i++) {
+            MYSQL_ROW row = snapshot->rows[i];
+            unsigned long *lengths =  // NOLINT
+                snapshot->lengths + i*num_fields;
+            for (j = 0; j < num_fields; j++) {
+                unsigned char *bitmap = out + column_starts[j] -
+                                        4*num_rows - bitmap_length;
+                unsigned char *column_value_lengths = bitmap + bitmap_length;
+
+                if (!row[j]) {
+                    bitmap[i/8] |= 1 << (i%8);
+                    continue;
+                }
+
+                PutUint32(column_value_lengths + 4*i, lengths[j]);
+                memcpy(out + column_starts[j] + column_lengths[j],
+                       row[j], lengths[j]);
+                column_lengths[j] += lengths[j];
+            }
+        }
+    }
+
+    free(column_lengths);
+
+    if (error) {
+        return error;
+    }
+
+    *data = reinterpret_cast<char *>(out);
+    *length = size;
+
+    return NULL;
+}
+
+/**
+ * Decodes serialize() output, checks all lengths against buffer size
+ *
+ * @ignore
+ */
+const char *MysqlResult::Decode(const unsigned char *data, size_t length,
+                                struct serialized_result **result) {
+    if (length < SERIALIZED_RESULT_HEADER_LENGTH ||
+        memcmp(data, SERIALIZED_RESULT_MAGIC, 4)) {
+        return "Buffer is not a serialized result";
+    }
+    if (data[4] != SERIALIZED_RESULT_VERSION) {
+        return "Unsupported serialized result version";
+    }
+
+    uint32_t num_fields = GetUint32(data + 8);
+    uint64_t num_rows = GetUint32(data + 12) |
+                        static_cast<uint64_t>(GetUint32(data + 16)) << 32;
+
+    // Each value takes at least its length
+    if (!num_fields || num_rows > length/4/num_fields) {
+        return "Serialized result is corrupted";
+    }
+
+    struct serialized_result *serialized =
+        reinterpret_cast<struct serialized_result *>(
+            calloc(1, sizeof(struct serialized_result)));
+
+    if (!serialized) {
+        return "Could not allocate enough memory";
+    }
+
+    serialized->num_fields = num_fields;
+    serialized->num_rows = num_rows;
+    serialized->lengths_row = -1;
+
+    size_t bitmap_length = (num_rows + 7)/8;
+    const unsigned char *end = data + length;
+    const char *error = NULL;
+    size_t data_size = 0;
+    char *to = NULL;
+
+    // First pass checks and measures, second one copies
+    for (int pass = 0; pass < 2 && !error; pass++) {
+        const unsigned char *p = data + SERIALIZED_RESULT_HEADER_LENGTH;
+
+        if (pass) {
+            serialized->fields = reinterpret_cast<MYSQL_FIELD *>(
+                calloc(num_fields, sizeof(MYSQL_FIELD)));
+            serialized->values = reinterpret_cast<char **>(
+                calloc(num_rows*num_fields + 1, sizeof(char *)));
+            serialized->lengths = reinterpret_cast<unsigned long *>(  // NOLINT
+                calloc(num_rows*num_fields + 1, sizeof(unsigned long)));  // NOLINT
+            serialized->data = reinterpret_cast<char *>(malloc(data_size + 1));
+
+            if (!serialized->fields || !serialized->values ||
+                !serialized->lengths || !serialized->data) {
+                error = "Could not allocate enough memory";
+                break;
+            }
+
+            to = serialized->data;
+        }
+
+        for (uint32_t j = 0; j < num_fields && !error; j++) {
+            MYSQL_FIELD *field = pass ? &serialized->fields[j] : NULL;
+
+            if (static_cast<size_t>(end - p) < 6*4) {
+                error = "Serialized result is corrupted";
+                break;
+            }
+
+            if (field) {
+                field->type = static_cast<enum_field_types>(GetUint32(p));
+                field->flags = GetUint32(p + 4);
+                field->decimals = GetUint32(p + 8);
+                field->charsetnr = GetUint32(p + 12);
+                field->length = GetUint32(p + 16);
+                field->max_length = GetUint32(p + 20);
+            }
+            p += 6*4;
+
+            for (int k = 0; k < 6; k++) {
+                if (static_cast<size_t>(end - p) < 4) {
+                    error = "Serialized result is corrupted";
+                    break;
+                }
+
+                uint32_t string_length = GetUint32(p);
+                p += 4;
+
+                if (string_length == 0xFFFFFFFFU) {
+                    // Only default value may be NULL, names are used as is
+                    if (k < 5) {
+                        error = "Serialized result is corrupted";
+                        break;
+                    }
+                    continue;
+                }
+                if (static_cast<size_t>(end - p) < string_length) {
+                    error = "Serialized result is corrupted";
+                    break;
+                }
+
+                if (field) {
+                    char **strings[6] = {&field->name, &field->org_name,
+                                         &field->table, &field->org_table,
+                                         &field->db, &field->def};
+                    memcpy(to, p, string_length);
+                    to[string_length] = '\0';
+                    *strings[k] = to;
+                    to += string_length + 1;
+                } else {
+                    data_size += string_length + 1;
+                }
+                p += string_length;
+            }
+        }
+
+        for (uint32_t j = 0; j < num_fields && !error; j++) {
+            if (static_cast<size_t>(end - p) < bitmap_length + 4*num_rows) {
+                error = "Serialized result is corrupted";
+                break;
+            }
+
+            const unsigned char *bitmap = p;
+            const unsigned char *value_lengths = p + bitmap_length;
+            p += bitmap_length + 4*num_rows;
+
+            for (uint64_t i = 0; i < num_rows; i++) {
+                if (bitmap[i/8] & (1 << (i%8))) {
+                    // Already NULL with zero length
+                    continue;
+                }
+
+                uint32_t value_length = GetUint32(value_lengths + 4*i);
+                if (static_cast<size_t>(end - p) < value_length) {
+                    error = "Serialized result is corrupted";
+                    break;
+                }
+
+                if (pass) {
+                    memcpy(to, p, value_length);
+                    to[value_length] = '\0';
+                    serialized->values[i*num_fields + j] = to;
+                    serialized->lengths[i*num_fields + j] = value_length;
+                    to += value_length + 1;
+                } else {
+                    data_size += value_length + 1;
+                }
+                p += value_length;
+            }
+        }
+
+        if (!error && p != end) {
+            error = "Serialized result is corrupted";
+        }
+    }
+
+    if (error) {
+        FreeSerialized(serialized);
+        return error;
+    }
+
+    *result = serialized;
+
+    return NULL;
+}
+
+void MysqlResult::FreeSerialized(struct serialized_result *serialized) {
+    free(serialized->fields);
+    free(serialized->values);
+    free(serialized->lengths);
+    free(serialized->data);
+    free(serialized);
 }
 
 /**
@@ -271,6 +888,9 @@ Handle<Value> MysqlResult::New(const Arguments& args) {
     uint32_t field_count = args[1]->IntegerValue();
     MYSQL_RES *res = static_cast<MYSQL_RES*>(js_res->Value());
     MysqlResult *my_res = new MysqlResult(res, field_count);
+    if (args.Length() > 2 && args[2]->IsInt32()) {
+        my_res->priority = args[2]->Int32Value();
+    }
     my_res->Wrap(args.This());
 
     return args.This();
@@ -311,19 +931,198 @@ Handle<Value> MysqlResult::DataSeekSync(const Arguments& args) {
 
     REQ_UINT_ARG(0, offset)
 
-    if (mysql_result_is_unbuffered(res->_res)) {
+    if (res->IsUnbuffered()) {
         return THREXC("Function cannot be used with MYSQL_USE_RESULT");
     }
 
-    if (offset < 0 || offset >= mysql_num_rows(res->_res)) {
+    if (offset < 0 || offset >= res->NumRows()) {
         return THREXC("Invalid row offset");
     }
 
-    mysql_data_seek(res->_res, offset);
+    res->DataSeek(offset);
 
     return Undefined();
 }
 
+/**
+ * Finds field by name or index, -1 if there is no such field
+ *
+ * @ignore
+ */
+int32_t MysqlResult::FieldIndex(MYSQL_FIELD *fields, uint32_t num_fields,
+                                Local<Value> js_column) {
+    if (js_column->IsUint32()) {
+        uint32_t index = js_column->Uint32Value();
+        return index < num_fields ? index : -1;
+    }
+
+    if (!js_column->IsString()) {
+        return -1;
+    }
+
+    String::Utf8Value column(js_column);
+
+    for (uint32_t j = 0; j < num_fields; j++) {
+        if (!strcmp(fields[j].name, *column)) {
+            return j;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Reads columns and where options of fetchAll(),
+ * returns error message or NULL
+ *
+ * @ignore
+ */
+const char *MysqlResult::ParseFetchOptions(Local<Object> js_options,
+                                           MYSQL_FIELD *fields,
+                                           uint32_t num_fields,
+                                           struct fetch_options *options) {
+    memset(options, 0, sizeof(struct fetch_options));
+    options->where_column = -1;
+
+    if (js_options->Has(V8STR("columns"))) {
+        Local<Value> js_columns = js_options->Get(V8STR("columns"));
+        if (!js_columns->IsArray()) {
+            return "columns must be an array of names or indexes";
+        }
+
+        Local<Array> js_columns_array = Local<Array>::Cast(js_columns);
+        uint32_t length = js_columns_array->Length();
+
+        options->columns = reinterpret_cast<uint32_t *>(
+            malloc((length + 1)*sizeof(uint32_t)));
+        if (!options->columns) {
+            return "Could not allocate enough memory";
+        }
+
+        for (uint32_t i = 0; i < length; i++) {
+            int32_t index = FieldIndex(fields, num_fields,
+                                       js_columns_array->Get(Integer::New(i)));
+            if (index < 0) {
+                return "Unknown column in columns option";
+            }
+            options->columns[options->columns_count++] = index;
+        }
+    }
+
+    if (js_options->Has(V8STR("where"))) {
+        Local<Value> js_where = js_options->Get(V8STR("where"));
+        if (!js_where->IsArray() ||
+            Local<Array>::Cast(js_where)->Length() != 3) {
+            return "where must be [column, operator, value]";
+        }
+
+        Local<Array> js_where_array = Local<Array>::Cast(js_where);
+
+        options->where_column = FieldIndex(fields, num_fields,
+                                           js_where_array->Get(Integer::New(0)));
+        if (options->where_column < 0) {
+            return "Unknown column in where option";
+        }
+
+        String::Utf8Value op(js_where_array->Get(Integer::New(1))->ToString());
+        if (!strcmp(*op, "=")) {
+            options->where_op = FETCH_WHERE_EQ;
+        } else if (!strcmp(*op, "!=") || !strcmp(*op, "<>")) {
+            options->where_op = FETCH_WHERE_NE;
+        } else if (!strcmp(*op, "<")) {
+            options->where_op = FETCH_WHERE_LT;
+        } else if (!strcmp(*op, "<=")) {
+            options->where_op = FETCH_WHERE_LE;
+        } else if (!strcmp(*op, ">")) {
+            options->where_op = FETCH_WHERE_GT;
+        } else if (!strcmp(*op, ">=")) {
+            options->where_op = FETCH_WHERE_GE;
+        } else {
+            return "Unknown operator in where option";
+        }
+
+        Local<Value> js_value = js_where_array->Get(Integer::New(2));
+        if (js_value->IsNull()) {
+            if (options->where_op != FETCH_WHERE_EQ &&
+                options->where_op != FETCH_WHERE_NE) {
+                return "null can be compared only with = and !=";
+            }
+            options->where_null = true;
+        } else if (js_value->IsNumber()) {
+            options->where_numeric = true;
+            options->where_number = js_value->NumberValue();
+        } else if (js_value->IsString()) {
+            String::Utf8Value value(js_value);
+            options->where_string = reinterpret_cast<char *>(
+                malloc(value.length() + 1));
+            if (!options->where_string) {
+                return "Could not allocate enough memory";
+            }
+            memcpy(options->where_string, *value, value.length() + 1);
+            options->where_string_length = value.length();
+        } else {
+            return "where value must be a number, string or null";
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Checks raw row against where option, NULL values match only null
+ *
+ * @ignore
+ */
+bool MysqlResult::FilterRow(struct fetch_options *options, MYSQL_ROW row,
+                            unsigned long *lengths) {  // NOLINT
+    const char *value = row[options->where_column];
+
+    if (options->where_null) {
+        return (options->where_op == FETCH_WHERE_EQ) == !value;
+    }
+    if (!value) {
+        return false;
+    }
+
+    int r;
+    if (options->where_numeric) {
+        double number = strtod(value, NULL);
+        r = number < options->where_number ? -1 :
+            (number > options->where_number);
+    } else {
+        size_t length = lengths[options->where_column];
+        size_t min_length = length < options->where_string_length ?
+                            length : options->where_string_length;
+        r = memcmp(value, options->where_string, min_length);
+        if (!r) {
+            r = length < options->where_string_length ? -1 :
+                (length > options->where_string_length);
+        }
+    }
+
+    switch (options->where_op) {
+        case FETCH_WHERE_EQ:
+            return r == 0;
+        case FETCH_WHERE_NE:
+            return r != 0;
+        case FETCH_WHERE_LT:
+            return r < 0;
+        case FETCH_WHERE_LE:
+            return r <= 0;
+        case FETCH_WHERE_GT:
+            return r > 0;
+        case FETCH_WHERE_GE:
+            return r >= 0;
+    }
+
+    return false;
+}
+
+void MysqlResult::FreeFetchOptions(struct fetch_options *options) {
+    free(options->columns);
+    free(options->where_string);
+}
+
 /**
  * EIO wrapper functions for MysqlResult::FetchAll
  */
@@ -342,26 +1141,36 @@ int MysqlResult::EIO_After_FetchAll(eio_req *req) {
         argv[0] = V8EXC("Error on fetching fields");
     } else {
         MYSQL_FIELD *fields = fetchAll_req->fields;
-        uint32_t num_fields = fetchAll_req->num_fields;
+        struct fetch_options *options = &fetchAll_req->options;
+        uint32_t num_fields = options->columns ?
+                              options->columns_count : fetchAll_req->num_fields;
         MYSQL_ROW result_row;
-        uint32_t i = 0, j = 0;
+        uint32_t i = 0, j = 0, k = 0;
 
         Local<Array> js_result = Array::New();
         Local<Object> js_result_row;
         Local<Value> js_field;
 
         i = 0;
-        while ( (result_row = mysql_fetch_row(fetchAll_req->res->_res)) ) {
+        while ( (result_row = fetchAll_req->res->FetchRow()) ) {
+            unsigned long *result_lengths = fetchAll_req->res->FetchLengths();  // NOLINT
+            if (options->where_column >= 0 &&
+                !FilterRow(options, result_row, result_lengths)) {
+                continue;
+            }
+
             if(fetchAll_req->results_array) {
               js_result_row = Array::New();
             } else {
               js_result_row = Object::New();
             }
 
-            for (j = 0; j < num_fields; j++) {
-                js_field = GetFieldValue(fields[j], result_row[j]);
+            for (k = 0; k < num_fields; k++) {
+                j = options->columns ? options->columns[k] : k;
+                js_field = GetFieldValue(fields[j], result_row[j],
+                                         result_lengths[j]);
                 if (fetchAll_req->results_array) {
-                    js_result_row->Set(Integer::New(j), js_field);
+                    js_result_row->Set(Integer::New(k), js_field);
                 } else {
                     if (fetchAll_req->results_structured) {
                         if (!js_result_row->Has(V8STR(fields[j].table))) {
@@ -398,6 +1207,7 @@ int MysqlResult::EIO_After_FetchAll(eio_req *req) {
 
     fetchAll_req->callback.Dispose();
     fetchAll_req->res->Unref();
+    FreeFetchOptions(&fetchAll_req->options);
     // TODO(Sannis): should I free this?
     //free(fetchAll_req->fields);
     free(fetchAll_req);
@@ -410,8 +1220,8 @@ int MysqlResult::EIO_FetchAll(eio_req *req) {
         reinterpret_cast<struct fetchAll_request *>(req->data);
     MysqlResult *res = fetchAll_req->res;
 
-    fetchAll_req->fields = mysql_fetch_fields(res->_res);
-    fetchAll_req->num_fields = mysql_num_fields(res->_res);
+    fetchAll_req->fields = res->FetchFields();
+    fetchAll_req->num_fields = res->NumFields();
 
     // TODO(Sannis): Make some error check here
 
@@ -424,7 +1234,13 @@ int MysqlResult::EIO_FetchAll(eio_req *req) {
 /**
  * Fetches all result rows as an array
  *
- * @param {Boolean|Object} options (optional)
+ * @param {Boolean|Object} options (optional), {priority: n} sets
+ *        thread pool priority of this call instead of the priority
+ *        of connection the result is from, {columns: [name or index]}
+ *        fetches only these columns, {where: [column, operator, value]}
+ *        fetches only rows where column compares to value with one of
+ *        =, !=, <>, <, <=, >, >=. Numbers compare by value, strings
+ *        bytewise, null matches NULL with = and !=
  * @param {Function(error, rows)} callback
  */
 Handle<Value> MysqlResult::FetchAll(const Arguments& args) {
@@ -435,6 +1251,9 @@ Handle<Value> MysqlResult::FetchAll(const Arguments& args) {
     int arg_pos = 0;
     bool results_array = false;
     bool results_structured = false;
+    MysqlResult *res = OBJUNWRAP<MysqlResult>(args.This()); // NOLINT
+    int priority = res->priority;
+    Local<Object> js_options = Object::New();
 
     if (args.Length() > 0) {
         if (args[0]->IsBoolean()) {
@@ -449,6 +1268,13 @@ Handle<Value> MysqlResult::FetchAll(const Arguments& args) {
                 results_structured = args[0]->ToObject()
                                      ->Get(V8STR("structured"))->BooleanValue();
             }
+            if (args[0]->ToObject()->Has(V8STR("priority")) &&
+                !MysqlScheduler::PriorityArg(
+                    args[0]->ToObject()->Get(V8STR("priority")), &priority)) {
+                return THRTYPEEXC("Priority must be an integer from "
+                                  "MysqlScheduler.PRIORITY_MIN to PRIORITY_MAX");
+            }
+            js_options = args[0]->ToObject();
             arg_pos++;
         }
         // NOT here: any function is object
@@ -461,8 +1287,6 @@ Handle<Value> MysqlResult::FetchAll(const Arguments& args) {
 
     REQ_FUN_ARG(arg_pos, callback)
 
-    MysqlResult *res = OBJUNWRAP<MysqlResult>(args.This()); // NOLINT
-
     MYSQLRES_MUSTBE_VALID;
 
     struct fetchAll_request *fetchAll_req = (struct fetchAll_request *)
@@ -473,12 +1297,22 @@ Handle<Value> MysqlResult::FetchAll(const Arguments& args) {
         return THREXC("Could not allocate enough memory");
     }
 
+    const char *error = ParseFetchOptions(js_options, res->FetchFields(),
+                                          res->NumFields(),
+                                          &fetchAll_req->options);
+    if (error) {
+        FreeFetchOptions(&fetchAll_req->options);
+        free(fetchAll_req);
+        return THRTYPEEXC(error);
+    }
+
     fetchAll_req->callback = Persistent<Function>::New(callback);
     fetchAll_req->res = res;
     fetchAll_req->results_array = results_array;
     fetchAll_req->results_structured = results_structured;
 
-    eio_custom(EIO_FetchAll, EIO_PRI_DEFAULT, EIO_After_FetchAll, fetchAll_req);
+    MysqlScheduler::Submit(EIO_FetchAll, EIO_After_FetchAll,
+                           priority, fetchAll_req);
 
     ev_ref(EV_DEFAULT_UC);
     res->Ref();
@@ -490,7 +1324,8 @@ Handle<Value> MysqlResult::FetchAll(const Arguments& args) {
 /**
  * Fetches all result rows as an array
  *
- * @param {Boolean|Object} options (optional)
+ * @param {Boolean|Object} options (optional), columns and where
+ *        options as in fetchAll()
  * @return {Array}
  */
 Handle<Value> MysqlResult::FetchAllSync(const Arguments& args) {
@@ -502,11 +1337,13 @@ Handle<Value> MysqlResult::FetchAllSync(const Arguments& args) {
 
     bool results_array = false;
     bool results_structured = false;
+    Local<Object> js_options = Object::New();
 
     if (args.Length() > 0) {
         if (args[0]->IsBoolean()) {
             results_array = args[0]->BooleanValue();
         } else if (args[0]->IsObject()) {
+            js_options = args[0]->ToObject();
             if (args[0]->ToObject()->Has(V8STR("array"))) {
                 results_array = args[0]->ToObject()
                                 ->Get(V8STR("array"))->BooleanValue();
@@ -522,27 +1359,44 @@ Handle<Value> MysqlResult::FetchAllSync(const Arguments& args) {
         return THREXC("You can't mix 'array' and 'structured' parameters");
     }
 
-    MYSQL_FIELD *fields = mysql_fetch_fields(res->_res);
-    uint32_t num_fields = mysql_num_fields(res->_res);
+    struct fetch_options options;
+    const char *error = ParseFetchOptions(js_options, res->FetchFields(),
+                                          res->NumFields(), &options);
+    if (error) {
+        FreeFetchOptions(&options);
+        return THRTYPEEXC(error);
+    }
+
+    MYSQL_FIELD *fields = res->FetchFields();
+    uint32_t num_fields = options.columns ?
+                          options.columns_count : res->NumFields();
     MYSQL_ROW result_row;
-    uint32_t i = 0, j = 0;
+    uint32_t i = 0, j = 0, k = 0;
 
     Local<Array> js_result = Array::New();
     Local<Object> js_result_row;
     Local<Value> js_field;
 
     i = 0;
-    while ( (result_row = mysql_fetch_row(res->_res)) ) {
+    while ( (result_row = res->FetchRow()) ) {
+        unsigned long *result_lengths = res->FetchLengths();  // NOLINT
+        if (options.where_column >= 0 &&
+            !FilterRow(&options, result_row, result_lengths)) {
+            continue;
+        }
+
         if (results_array) {
             js_result_row = Array::New();
         } else {
             js_result_row = Object::New();
         }
 
-        for (j = 0; j < num_fields; j++) {
-            js_field = GetFieldValue(fields[j], result_row[j]);
+        for (k = 0; k < num_fields; k++) {
+            j = options.columns ? options.columns[k] : k;
+            js_field = GetFieldValue(fields[j], result_row[j],
+                                     result_lengths[j]);
             if (results_array) {
-                js_result_row->Set(Integer::New(j), js_field);
+                js_result_row->Set(Integer::New(k), js_field);
             } else {
                 if (results_structured) {
                     if (!js_result_row->Has(V8STR(fields[j].table))) {
@@ -561,6 +1415,8 @@ Handle<Value> MysqlResult::FetchAllSync(const Arguments& args) {
         i++;
     }
 
+    FreeFetchOptions(&options);
+
     return scope.Close(js_result);
 }
 
@@ -576,23 +1432,26 @@ Handle<Value> MysqlResult::FetchArraySync(const Arguments& args) {
 
     MYSQLRES_MUSTBE_VALID;
 
-    MYSQL_FIELD *fields = mysql_fetch_fields(res->_res);
-    uint32_t num_fields = mysql_num_fields(res->_res);
+    MYSQL_FIELD *fields = res->FetchFields();
+    uint32_t num_fields = res->NumFields();
     uint32_t j = 0;
 
     Local<Array> js_result_row;
     Local<Value> js_field;
 
-    MYSQL_ROW result_row = mysql_fetch_row(res->_res);
+    MYSQL_ROW result_row = res->FetchRow();
 
     if (!result_row) {
         return scope.Close(False());
     }
 
+    unsigned long *result_lengths = res->FetchLengths();  // NOLINT
+
     js_result_row = Array::New();
 
     for ( j = 0; j < num_fields; j++ ) {
-        js_field = GetFieldValue(fields[j], result_row[j]);
+        js_field = GetFieldValue(fields[j], result_row[j],
+                                 result_lengths[j]);
 
         js_result_row->Set(Integer::New(j), js_field);
     }
@@ -616,7 +1475,7 @@ Handle<Value> MysqlResult::FetchFieldSync(const Arguments& args) {
 
     Local<Object> js_result;
 
-    field = mysql_fetch_field(res->_res);
+    field = res->FetchField();
 
     if (!field) {
         return scope.Close(False());
@@ -647,7 +1506,7 @@ Handle<Value> MysqlResult::FetchFieldDirectSync(const Arguments& args) { // NOLI
 
     Local<Object> js_result;
 
-    field = mysql_fetch_field_direct(res->_res, field_num);
+    field = res->FetchFieldDirect(field_num);
 
     if (!field) {
         return scope.Close(False());
@@ -671,7 +1530,7 @@ Handle<Value> MysqlResult::FetchFieldsSync(const Arguments& args) {
 
     MYSQLRES_MUSTBE_VALID;
 
-    uint32_t num_fields = mysql_num_fields(res->_res);
+    uint32_t num_fields = res->NumFields();
     MYSQL_FIELD *field;
     uint32_t i = 0;
 
@@ -679,7 +1538,7 @@ Handle<Value> MysqlResult::FetchFieldsSync(const Arguments& args) {
     Local<Object> js_result_obj;
 
     for (i = 0; i < num_fields; i++) {
-        field = mysql_fetch_field_direct(res->_res, i);
+        field = res->FetchFieldDirect(i);
 
         js_result_obj = Object::New();
         AddFieldProperties(js_result_obj, field);
@@ -702,8 +1561,8 @@ Handle<Value> MysqlResult::FetchLengthsSync(const Arguments& args) {
 
     MYSQLRES_MUSTBE_VALID;
 
-    uint32_t num_fields = mysql_num_fields(res->_res);
-    unsigned long int *lengths = mysql_fetch_lengths(res->_res); // NOLINT (unsigned long required by API)
+    uint32_t num_fields = res->NumFields();
+    unsigned long int *lengths = res->FetchLengths(); // NOLINT (unsigned long required by API)
     uint32_t i = 0;
 
     Local<Array> js_result = Array::New();
@@ -731,24 +1590,27 @@ Handle<Value> MysqlResult::FetchObjectSync(const Arguments& args) {
 
     MYSQLRES_MUSTBE_VALID;
 
-    MYSQL_FIELD *fields = mysql_fetch_fields(res->_res);
-    uint32_t num_fields = mysql_num_fields(res->_res);
+    MYSQL_FIELD *fields = res->FetchFields();
+    uint32_t num_fields = res->NumFields();
     MYSQL_ROW result_row;
     uint32_t j = 0;
 
     Local<Object> js_result_row;
     Local<Value> js_field;
 
-    result_row = mysql_fetch_row(res->_res);
+    result_row = res->FetchRow();
 
     if (!result_row) {
         return scope.Close(False());
     }
 
+    unsigned long *result_lengths = res->FetchLengths();  // NOLINT
+
     js_result_row = Object::New();
 
     for ( j = 0; j < num_fields; j++ ) {
-        js_field = GetFieldValue(fields[j], result_row[j]);
+        js_field = GetFieldValue(fields[j], result_row[j],
+                                 result_lengths[j]);
 
         js_result_row->Set(V8STR(fields[j].name), js_field);
     }
@@ -774,7 +1636,7 @@ Handle<Value> MysqlResult::FieldSeekSync(const Arguments& args) {
         return THREXC("Invalid field offset");
     }
 
-    mysql_field_seek(res->_res, field_num);
+    res->FieldSeek(field_num);
 
     return Undefined();
 }
@@ -791,7 +1653,7 @@ Handle<Value> MysqlResult::FieldTellSync(const Arguments& args) {
 
     MYSQLRES_MUSTBE_VALID;
 
-    return scope.Close(Integer::New(mysql_field_tell(res->_res)));
+    return scope.Close(Integer::New(res->FieldTell()));
 }
 
 /**
@@ -804,6 +1666,10 @@ Handle<Value> MysqlResult::FreeSync(const Arguments& args) {
 
     MYSQLRES_MUSTBE_VALID;
 
+    if (res->serializing) {
+        return THREXC("Result can't be freed while serialize() is running");
+    }
+
     res->Free();
 
     return Undefined();
@@ -821,10 +1687,155 @@ Handle<Value> MysqlResult::NumRowsSync(const Arguments& args) {
 
     MYSQLRES_MUSTBE_VALID;
 
-    if (mysql_result_is_unbuffered(res->_res)) {
+    if (res->IsUnbuffered()) {
         return THREXC("Function cannot be used with MYSQL_USE_RESULT");
     }
 
-    return scope.Close(Integer::New(mysql_num_rows(res->_res)));
+    return scope.Close(Integer::New(res->NumRows()));
+}
+
+/**
+ * EIO wrapper functions for MysqlResult::Serialize
+ */
+#ifndef MYSQL_NON_THREADSAFE
+int MysqlResult::EIO_After_Serialize(eio_req *req) {
+    ev_unref(EV_DEFAULT_UC);
+    HandleScope scope;
+    struct serialize_request *serialize_req =
+        reinterpret_cast<struct serialize_request *>(req->data);
+
+    int argc = 1;
+    Local<Value> argv[2];
+
+    if (req->result) {
+        argv[0] = V8EXC(serialize_req->error);
+    } else {
+        node::Buffer *buffer = node::Buffer::New(serialize_req->data,
+                                                 serialize_req->length);
+        argv[0] = Local<Value>::New(Null());
+        argv[1] = Local<Value>::New(buffer->handle_);
+        argc = 2;
+    }
+
+    // Rows are not read anymore, callback may free result
+    serialize_req->res->serializing--;
+    FreeSnapshot(&serialize_req->snapshot);
+
+    TryCatch try_catch;
+
+    serialize_req->callback->Call(Context::GetCurrent()->Global(), argc, argv);
+
+    if (try_catch.HasCaught()) {
+        node::FatalException(try_catch);
+    }
+
+    serialize_req->callback.Dispose();
+    serialize_req->res->Unref();
+    free(serialize_req->data);
+    free(serialize_req);
+
+    return 0;
+}
+
+int MysqlResult::EIO_Serialize(eio_req *req) {
+    struct serialize_request *serialize_req =
+        reinterpret_cast<struct serialize_request *>(req->data);
+
+    serialize_req->error = Encode(&serialize_req->snapshot,
+                                  &serialize_req->data,
+                                  &serialize_req->length);
+    req->result = serialize_req->error ? 1 : 0;
+
+    return 0;
 }
+#endif
 
+/**
+ * Encodes all rows to compact binary form for caching or sending
+ * to other process, see MysqlResult.deserializeSync(). Row pointers
+ * are collected before worker starts, freeSync() throws until callback
+ *
+ * @param {Function(error, buffer)} callback
+ */
+Handle<Value> MysqlResult::Serialize(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    REQ_FUN_ARG(0, callback);
+
+    MysqlResult *res = OBJUNWRAP<MysqlResult>(args.This());
+
+    MYSQLRES_MUSTBE_VALID;
+
+    if (res->IsUnbuffered()) {
+        return THREXC("Function cannot be used with MYSQL_USE_RESULT");
+    }
+
+    struct serialize_request *serialize_req =
+        reinterpret_cast<struct serialize_request *>(
+            calloc(1, sizeof(struct serialize_request)));
+
+    if (!serialize_req) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    const char *error = res->Snapshot(&serialize_req->snapshot);
+    if (error) {
+        free(serialize_req);
+        V8::LowMemoryNotification();
+        return THREXC(error);
+    }
+
+    serialize_req->callback = Persistent<Function>::New(callback);
+    serialize_req->res = res;
+
+    // Worker reads rows memory, freeSync() must wait
+    res->serializing++;
+
+    MysqlScheduler::Submit(EIO_Serialize, EIO_After_Serialize,
+                           res->priority, serialize_req);
+
+    ev_ref(EV_DEFAULT_UC);
+    res->Ref();
+
+    return Undefined();
+#endif
+}
+
+/**
+ * Creates result from serialize() output, it supports
+ * all fetch methods without database connection
+ *
+ * @param {Buffer} buffer
+ * @return {MysqlResult}
+ */
+Handle<Value> MysqlResult::DeserializeSync(const Arguments& args) {
+    HandleScope scope;
+
+    if (args.Length() < 1 || !node::Buffer::HasInstance(args[0])) {
+        return THRTYPEEXC("Argument 0 must be a Buffer");
+    }
+
+    Local<Object> js_buffer = args[0]->ToObject();
+    struct serialized_result *serialized;
+
+    const char *error = Decode(
+        reinterpret_cast<const unsigned char *>(node::Buffer::Data(js_buffer)),
+        node::Buffer::Length(js_buffer), &serialized);
+
+    if (error) {
+        return THREXC(error);
+    }
+
+    Local<Value> argv[2];
+    argv[0] = External::New(NULL);
+    argv[1] = Integer::New(serialized->num_fields);
+    Local<Object> js_result = constructor_template->
+                              GetFunction()->NewInstance(2, argv);
+
+    OBJUNWRAP<MysqlResult>(js_result)->_serialized = serialized;
+
+    return scope.Close(js_result);
+}
@@ -17,8 +17,13 @@ See license text in LICENSE file
 #define mysql_result_is_unbuffered(r) \
 ((r)->handle && (r)->handle->status == MYSQL_STATUS_USE_RESULT)
 
+// Format of serialize() output, bump on incompatible changes
+#define SERIALIZED_RESULT_MAGIC "MYRS"
+#define SERIALIZED_RESULT_VERSION 1
+#define SERIALIZED_RESULT_HEADER_LENGTH 20
+
 #define MYSQLRES_MUSTBE_VALID \
-    if (!res->_res) { \
+    if (!res->_res && !res->_serialized) { \
         return THREXC("Result has been freed."); \
     }
 
@@ -35,6 +40,7 @@ static Persistent<String> result_fieldSeekSync_symbol;
 static Persistent<String> result_fieldTellSync_symbol;
 static Persistent<String> result_freeSync_symbol;
 static Persistent<String> result_numRowsSync_symbol;
+static Persistent<String> result_serialize_symbol;
 
 class MysqlResult : public node::EventEmitter {
   public:
@@ -46,7 +52,14 @@ class MysqlResult : public node::EventEmitter {
                                     Local<Object> &js_field_obj,
                                     MYSQL_FIELD *field);
 
-    static Local<Value> GetFieldValue(MYSQL_FIELD field, char* field_value);
+    static Local<String> GetFieldString(MYSQL_FIELD field,
+                                        const char *field_value,
+                                        unsigned long field_length);  // NOLINT
+
+    static Local<Value> GetFieldValue(MYSQL_FIELD field, char* field_value,
+                                      unsigned long field_length);  // NOLINT
+
+    static Local<Array> RowsToArray(MYSQL_RES *my_result);
 
     void Free();
 
@@ -55,12 +68,84 @@ class MysqlResult : public node::EventEmitter {
 
     uint32_t field_count;
 
+    // Result decoded by deserializeSync(), used instead of _res
+    struct serialized_result {
+        MYSQL_FIELD *fields;
+        uint32_t num_fields;
+        uint64_t num_rows;
+        // Row-major values and lengths, values are NUL-terminated
+        char **values;
+        unsigned long *lengths;  // NOLINT (unsigned long required by API)
+        char *data;
+        uint64_t current_row;
+        int64_t lengths_row;
+        uint32_t current_field;
+    };
+    struct serialized_result *_serialized;
+
+    // Row pointers and lengths collected for serialize() worker
+    struct rows_snapshot {
+        MYSQL_FIELD *fields;
+        uint32_t num_fields;
+        uint64_t num_rows;
+        MYSQL_ROW *rows;
+        unsigned long *lengths;  // NOLINT (unsigned long required by API)
+    };
+    // serialize() calls in progress, result can't be freed meanwhile
+    uint32_t serializing;
+
+    // Thread pool priority of owning connection for asynchronous calls
+    int priority;
+
     MysqlResult();
 
     explicit MysqlResult(MYSQL_RES *my_result, uint32_t my_field_count):
                                                 EventEmitter(),
                                                 _res(my_result),
-                                                field_count(my_field_count) {}
+                                                field_count(my_field_count),
+                                                _serialized(NULL),
+                                                serializing(0),
+                                                priority(EIO_PRI_DEFAULT) {}
+
+    // Same as mysql_* functions, work on both kinds of result
+
+    MYSQL_FIELD *FetchFields();
+
+    uint32_t NumFields();
+
+    my_ulonglong NumRows();
+
+    void DataSeek(my_ulonglong offset);
+
+    MYSQL_ROW FetchRow();
+
+    unsigned long *FetchLengths();  // NOLINT
+
+    MYSQL_FIELD *FetchField();
+
+    MYSQL_FIELD *FetchFieldDirect(uint32_t field_num);
+
+    void FieldSeek(MYSQL_FIELD_OFFSET offset);
+
+    MYSQL_FIELD_OFFSET FieldTell();
+
+    bool IsUnbuffered();
+
+    static void PutUint32(unsigned char *to, uint32_t value);
+
+    static uint32_t GetUint32(const unsigned char *from);
+
+    const char *Snapshot(struct rows_snapshot *snapshot);
+
+    static void FreeSnapshot(struct rows_snapshot *snapshot);
+
+    static const char *Encode(const struct rows_snapshot *snapshot,
+                              char **data, size_t *length);
+
+    static const char *Decode(const unsigned char *data, size_t length,
+                              struct serialized_result **result);
+
+    static void FreeSerialized(struct serialized_result *serialized);
 
     ~MysqlResult();
 
@@ -77,6 +162,39 @@ class MysqlResult : public node::EventEmitter {
 
     static Handle<Value> DataSeekSync(const Arguments& args);
 
+    enum fetch_where_op {
+        FETCH_WHERE_EQ,
+        FETCH_WHERE_NE,
+        FETCH_WHERE_LT,
+        FETCH_WHERE_LE,
+        FETCH_WHERE_GT,
+        FETCH_WHERE_GE
+    };
+    // Projection and row filter of fetchAll()
+    struct fetch_options {
+        // Indexes of fetched columns, all columns if NULL
+        uint32_t *columns;
+        uint32_t columns_count;
+
+        // Rows where column op value, no filter if where_column < 0
+        int32_t where_column;
+        enum fetch_where_op where_op;
+        bool where_null;
+        bool where_numeric;
+        double where_number;
+        char *where_string;
+        size_t where_string_length;
+    };
+    static int32_t FieldIndex(MYSQL_FIELD *fields, uint32_t num_fields,
+                              Local<Value> js_column);
+    static const char *ParseFetchOptions(Local<Object> js_options,
+                                         MYSQL_FIELD *fields,
+                                         uint32_t num_fields,
+                                         struct fetch_options *options);
+    static bool FilterRow(struct fetch_options *options, MYSQL_ROW row,
+                          unsigned long *lengths);  // NOLINT
+    static void FreeFetchOptions(struct fetch_options *options);
+
 #ifndef MYSQL_NON_THREADSAFE
     struct fetchAll_request {
         Persistent<Function> callback;
@@ -86,6 +204,7 @@ class MysqlResult : public node::EventEmitter {
         uint32_t num_fields;
         bool results_array;
         bool results_structured;
+        struct fetch_options options;
     };
     static int EIO_After_FetchAll(eio_req *req);
     static int EIO_FetchAll(eio_req *req);
@@ -113,6 +232,25 @@ class MysqlResult : public node::EventEmitter {
     static Handle<Value> FreeSync(const Arguments& args);
 
     static Handle<Value> NumRowsSync(const Arguments& args);
+
+#ifndef MYSQL_NON_THREADSAFE
+    struct serialize_request {
+        Persistent<Function> callback;
+        MysqlResult *res;
+
+        struct rows_snapshot snapshot;
+        char *data;
+        size_t length;
+        const char *error;
+    };
+    static int EIO_After_Serialize(eio_req *req);
+    static int EIO_Serialize(eio_req *req);
+#endif
+    static Handle<Value> Serialize(const Arguments& args);
+
+    // Static methods
+
+    static Handle<Value> DeserializeSync(const Arguments& args);
 };
 
 #endif  // SRC_MYSQL_BINDINGS_RESULT_H_
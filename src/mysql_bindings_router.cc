@@ -0,0 +1,409 @@
+/*!
+ * Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+ * See contributors list in README
+ *
+ * See license text in LICENSE file
+ */
+
+/**
+ * Include headers
+ *
+ * @ignore
+ */
+#include "./mysql_bindings_connection.h"
+#include "./mysql_bindings_router.h"
+
+/**
+ * Init V8 structures for MysqlRouter class
+ *
+ * @ignore
+ */
+Persistent<FunctionTemplate> MysqlRouter::constructor_template;
+Persistent<Function> MysqlRouter::query_callback;
+
+void MysqlRouter::Init(Handle<Object> target) {
+    HandleScope scope;
+
+    Local<FunctionTemplate> t = FunctionTemplate::New(New);
+
+    // Constructor
+    constructor_template = Persistent<FunctionTemplate>::New(t);
+    constructor_template->Inherit(EventEmitter::constructor_template);
+    constructor_template->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor_template->SetClassName(String::NewSymbol("MysqlRouter"));
+
+    // Methods
+    ADD_PROTOTYPE_METHOD(router, query, Query);
+    ADD_PROTOTYPE_METHOD(router, querySync, QuerySync);
+    ADD_PROTOTYPE_METHOD(router, setReadYourWritesSync, SetReadYourWritesSync);
+
+    // Native callbacks, bound to per-query data on each call
+    query_callback = Persistent<Function>::New(
+        FunctionTemplate::New(QueryCallback)->GetFunction());
+
+    // Make it visible in JavaScript
+    target->Set(String::NewSymbol("MysqlRouter"),
+                constructor_template->GetFunction());
+}
+
+MysqlRouter::MysqlRouter(): EventEmitter() {
+    replicas_count = 0;
+    replicas_pending = NULL;
+    next_replica = 0;
+    in_transaction = false;
+    read_your_writes = false;
+    read_your_writes_window = 0;
+    last_write = 0;
+}
+
+MysqlRouter::~MysqlRouter() {
+    primary.Dispose();
+    replicas.Dispose();
+    free(replicas_pending);
+}
+
+/**
+ * Checks if query starts with keyword followed by non-word character
+ *
+ * @ignore
+ */
+bool MysqlRouter::StartsWithKeyword(const char *query, const char *keyword) {
+    while (isspace(*query) || *query == '(') {
+        query++;
+    }
+
+    size_t length = strlen(keyword);
+
+    return !strncasecmp(query, keyword, length) &&
+           !isalnum(query[length]) && query[length] != '_';
+}
+
+bool MysqlRouter::IsTransactionStart(const char *query) {
+    return StartsWithKeyword(query, "BEGIN") ||
+           StartsWithKeyword(query, "START TRANSACTION");
+}
+
+bool MysqlRouter::IsTransactionEnd(const char *query) {
+    if (StartsWithKeyword(query, "COMMIT")) {
+        return true;
+    }
+    if (!StartsWithKeyword(query, "ROLLBACK")) {
+        return false;
+    }
+
+    // ROLLBACK [WORK] TO SAVEPOINT keeps transaction open
+    for (; *query; query++) {
+        if (!strncasecmp(query, " TO ", 4)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Checks if read query depends on session state of the connection
+ * where previous writes were made
+ *
+ * @ignore
+ */
+bool MysqlRouter::IsSessionBoundRead(const char *query) {
+    static const char *session_functions[] = {
+        "LAST_INSERT_ID", "FOUND_ROWS", "ROW_COUNT", "GET_LOCK",
+        "RELEASE_LOCK", "IS_FREE_LOCK", "IS_USED_LOCK", "@", NULL
+    };
+
+    char quote = 0;
+
+    for (; *query; query++) {
+        // Text in quotes, like 'a@b.com', is not a variable or call
+        if (quote) {
+            if (*query == '\\' && quote != '`' && query[1]) {
+                query++;
+            } else if (*query == quote) {
+                quote = 0;
+            }
+            continue;
+        }
+        if (*query == '\'' || *query == '"' || *query == '`') {
+            quote = *query;
+            continue;
+        }
+
+        for (int i = 0; session_functions[i]; i++) {
+            if (!strncasecmp(query, session_functions[i],
+                             strlen(session_functions[i]))) {
+                return true;
+            }
+        }
+    }
+
+    // Unclosed quote means escaping was read wrong, primary is safe
+    return quote != 0;
+}
+
+/**
+ * Selects connection for query and updates transaction state
+ *
+ * @ignore
+ */
+Local<Object> MysqlRouter::Route(const char *query, int32_t *replica_index) {
+    ev_tstamp now = ev_now(EV_DEFAULT_UC);
+
+    *replica_index = -1;
+
+    if (IsTransactionStart(query)) {
+        in_transaction = true;
+    }
+
+    if (in_transaction) {
+        if (IsTransactionEnd(query)) {
+            in_transaction = false;
+        }
+        last_write = now;
+        return Local<Object>::New(primary);
+    }
+
+    if (!MysqlConnection::IsIdempotentQuery(query, strlen(query)) ||
+        IsSessionBoundRead(query)) {
+        last_write = now;
+        return Local<Object>::New(primary);
+    }
+
+    if (read_your_writes && last_write &&
+        (!read_your_writes_window ||
+         now - last_write < read_your_writes_window)) {
+        return Local<Object>::New(primary);
+    }
+
+    // Least busy replica, round robin between equally busy ones
+    int32_t best = -1;
+    for (uint32_t k = 0; k < replicas_count; k++) {
+        uint32_t i = (next_replica + k) % replicas_count;
+
+        if (best >= 0 && replicas_pending[i] >= replicas_pending[best]) {
+            continue;
+        }
+
+        Local<Object> js_replica = replicas->Get(Integer::New(i))->ToObject();
+        Local<Value> js_connected = js_replica->Get(V8STR("connectedSync"));
+        if (js_connected->IsFunction() &&
+            !Local<Function>::Cast(js_connected)->
+                Call(js_replica, 0, NULL)->BooleanValue()) {
+            continue;
+        }
+
+        best = i;
+    }
+
+    if (best < 0) {
+        // No live replicas
+        return Local<Object>::New(primary);
+    }
+
+    next_replica = (best + 1) % replicas_count;
+    *replica_index = best;
+
+    return replicas->Get(Integer::New(best))->ToObject();
+}
+
+/**
+ * Creates new MysqlRouter object
+ *
+ * @constructor
+ * @param {MysqlConnection} primary connection or pool, explicit
+ *        transactions throw with pool primary
+ * @param {Array} replica connections or pools
+ */
+Handle<Value> MysqlRouter::New(const Arguments& args) {
+    HandleScope scope;
+
+    if (args.Length() < 1 || !args[0]->IsObject()) {
+        return THRTYPEEXC("Argument 0 must be a connection");
+    }
+
+    if (args.Length() > 1 && !args[1]->IsArray()) {
+        return THRTYPEEXC("Argument 1 must be an array of connections");
+    }
+
+    Local<Array> js_replicas = args.Length() > 1 ?
+                               Local<Array>::Cast(args[1]) : Array::New();
+
+    for (uint32_t i = 0; i < js_replicas->Length(); i++) {
+        if (!js_replicas->Get(Integer::New(i))->IsObject()) {
+            return THRTYPEEXC("Argument 1 must be an array of connections");
+        }
+    }
+
+    MysqlRouter *router = new MysqlRouter();
+
+    router->primary = Persistent<Object>::New(args[0]->ToObject());
+    router->replicas = Persistent<Array>::New(js_replicas);
+    router->replicas_count = js_replicas->Length();
+    router->replicas_pending = reinterpret_cast<uint32_t *>(
+        calloc(router->replicas_count + 1, sizeof(uint32_t)));
+
+    router->Wrap(args.This());
+
+    args.This()->Set(V8STR("primary"), args[0]);
+    args.This()->Set(V8STR("replicas"), js_replicas);
+
+    return args.This();
+}
+
+/**
+ * Tracks finished query and calls original callback
+ *
+ * @ignore
+ */
+Handle<Value> MysqlRouter::QueryCallback(const Arguments& args) {
+    HandleScope scope;
+
+    struct query_data *data = static_cast<struct query_data *>(
+        Local<External>::Cast(args[0])->Value());
+
+    if (data->replica_index >= 0) {
+        data->router->replicas_pending[data->replica_index]--;
+    }
+
+    int argc = args.Length() - 1 < 2 ? args.Length() - 1 : 2;
+    Local<Value> argv[2];
+    for (int i = 0; i < argc; i++) {
+        argv[i] = args[i + 1];
+    }
+
+    Local<Function> callback = Local<Function>::New(data->callback);
+
+    data->callback.Dispose();
+    data->router->Unref();
+    delete data;
+
+    return scope.Close(callback->Call(Context::GetCurrent()->Global(),
+                                      argc, argv));
+}
+
+/**
+ * Performs query asynchronously on primary or replica connection,
+ * writes, session bound reads and explicit transactions go to primary
+ *
+ * @param {String} query
+ * @param {Function(error, result)} callback
+ */
+Handle<Value> MysqlRouter::Query(const Arguments& args) {
+    HandleScope scope;
+
+    REQ_STR_ARG(0, query);
+    REQ_FUN_ARG(1, callback);
+
+    MysqlRouter *router = OBJUNWRAP<MysqlRouter>(args.This());
+
+    // Pool runs each query on other connection and resets it after
+    if (IsTransactionStart(*query) &&
+        !MysqlConnection::constructor_template->HasInstance(router->primary)) {
+        return THREXC("Explicit transactions need a MysqlConnection primary");
+    }
+
+    int32_t replica_index;
+    Local<Object> js_conn = router->Route(*query, &replica_index);
+
+    Local<Value> js_query = js_conn->Get(V8STR("query"));
+    if (!js_query->IsFunction()) {
+        return THRTYPEEXC("Connection has no query() method");
+    }
+
+    struct query_data *data = new query_data;
+    data->callback = Persistent<Function>::New(callback);
+    data->router = router;
+    data->replica_index = replica_index;
+
+    if (replica_index >= 0) {
+        router->replicas_pending[replica_index]++;
+    }
+    router->Ref();
+
+    Local<Value> argv[2];
+    argv[0] = args[0];
+    argv[1] = MysqlScheduler::BindCallback(query_callback,
+                                           External::New(data));
+
+    TryCatch try_catch;
+
+    Local<Function>::Cast(js_query)->Call(js_conn, 2, argv);
+
+    if (try_catch.HasCaught()) {
+        // Query was not queued, so callback will never be called
+        if (replica_index >= 0) {
+            router->replicas_pending[replica_index]--;
+        }
+        data->callback.Dispose();
+        router->Unref();
+        delete data;
+        return ThrowException(try_catch.Exception());
+    }
+
+    return Undefined();
+}
+
+/**
+ * Performs query synchronously on primary or replica connection
+ *
+ * @param {String} query
+ * @return {MysqlResult|Boolean}
+ */
+Handle<Value> MysqlRouter::QuerySync(const Arguments& args) {
+    HandleScope scope;
+
+    REQ_STR_ARG(0, query);
+
+    MysqlRouter *router = OBJUNWRAP<MysqlRouter>(args.This());
+
+    // Pool runs each query on other connection and resets it after
+    if (IsTransactionStart(*query) &&
+        !MysqlConnection::constructor_template->HasInstance(router->primary)) {
+        return THREXC("Explicit transactions need a MysqlConnection primary");
+    }
+
+    int32_t replica_index;
+    Local<Object> js_conn = router->Route(*query, &replica_index);
+
+    Local<Value> js_query = js_conn->Get(V8STR("querySync"));
+    if (!js_query->IsFunction()) {
+        return THRTYPEEXC("Connection has no querySync() method");
+    }
+
+    Local<Value> argv[1];
+    argv[0] = args[0];
+
+    return scope.Close(Local<Function>::Cast(js_query)->Call(js_conn, 1, argv));
+}
+
+/**
+ * Sends reads to primary after a write, so they see written data
+ * despite replication lag
+ *
+ * @param {Boolean} enable
+ * @param {Integer|null} window in ms after last write, 0 or null
+ *                       pins reads to primary until disabled
+ * @return {Boolean}
+ */
+Handle<Value> MysqlRouter::SetReadYourWritesSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlRouter *router = OBJUNWRAP<MysqlRouter>(args.This());
+
+    REQ_BOOL_ARG(0, enable)
+
+    router->read_your_writes_window = 0;
+    if (args.Length() > 1 && !args[1]->IsNull() && !args[1]->IsUndefined()) {
+        REQ_UINT_ARG(1, window)
+        router->read_your_writes_window = window/1000.0;
+    }
+
+    router->read_your_writes = enable;
+    if (!enable) {
+        router->last_write = 0;
+    }
+
+    return scope.Close(True());
+}
+
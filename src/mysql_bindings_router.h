@@ -0,0 +1,78 @@
+/*
+Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+See contributors list in README
+
+See license text in LICENSE file
+*/
+
+#ifndef NODE_MYSQL_ROUTER_H  // NOLINT
+#define NODE_MYSQL_ROUTER_H
+
+#include <v8.h>
+#include <node.h>
+#include <node_events.h>
+
+#include "./mysql_bindings.h"
+
+static Persistent<String> router_query_symbol;
+static Persistent<String> router_querySync_symbol;
+static Persistent<String> router_setReadYourWritesSync_symbol;
+
+class MysqlRouter : public node::EventEmitter {
+  public:
+    static Persistent<FunctionTemplate> constructor_template;
+
+    static void Init(Handle<Object> target);
+
+    static bool StartsWithKeyword(const char *query, const char *keyword);
+
+    static bool IsTransactionStart(const char *query);
+
+    static bool IsTransactionEnd(const char *query);
+
+    static bool IsSessionBoundRead(const char *query);
+
+  protected:
+    // Connections or pools, anything with query() and querySync() methods
+    Persistent<Object> primary;
+    Persistent<Array> replicas;
+    uint32_t replicas_count;
+
+    // Asynchronous queries in flight on each replica
+    uint32_t *replicas_pending;
+    uint32_t next_replica;
+
+    bool in_transaction;
+
+    bool read_your_writes;
+    ev_tstamp read_your_writes_window;
+    ev_tstamp last_write;
+
+    MysqlRouter();
+
+    ~MysqlRouter();
+
+    Local<Object> Route(const char *query, int32_t *replica_index);
+
+    // Constructor
+
+    static Handle<Value> New(const Arguments& args);
+
+    // Methods
+
+    struct query_data {
+        Persistent<Function> callback;
+        MysqlRouter *router;
+        int32_t replica_index;
+    };
+    static Persistent<Function> query_callback;
+    static Handle<Value> QueryCallback(const Arguments& args);
+    static Handle<Value> Query(const Arguments& args);
+
+    static Handle<Value> QuerySync(const Arguments& args);
+
+    static Handle<Value> SetReadYourWritesSync(const Arguments& args);
+};
+
+#endif  // NODE_MYSQL_ROUTER_H  // NOLINT
+
@@ -0,0 +1,403 @@
+/*!
+ * Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+ * See contributors list in README
+ *
+ * See license text in LICENSE file
+ */
+
+/**
+ * Include headers
+ *
+ * @ignore
+ */
+#include "./mysql_bindings_scheduler.h"
+
+#include <cstdlib>
+
+/**
+ * Init V8 structures for MysqlScheduler object
+ *
+ * @ignore
+ */
+struct MysqlScheduler::job *MysqlScheduler::pending_head = NULL;
+struct MysqlScheduler::job *MysqlScheduler::pending_tail = NULL;
+uint32_t MysqlScheduler::pending_count = 0;
+uint32_t MysqlScheduler::low_priority_running = 0;
+uint32_t MysqlScheduler::low_priority_limit = 0;
+
+struct MysqlScheduler::job *
+    MysqlScheduler::queue_head[EIO_PRI_MAX - EIO_PRI_MIN + 1];
+struct MysqlScheduler::job *
+    MysqlScheduler::queue_tail[EIO_PRI_MAX - EIO_PRI_MIN + 1];
+uint32_t MysqlScheduler::queue_length = 0;
+
+struct MysqlScheduler::job *MysqlScheduler::done_head = NULL;
+struct MysqlScheduler::job *MysqlScheduler::done_tail = NULL;
+
+pthread_mutex_t MysqlScheduler::queue_lock;
+pthread_cond_t MysqlScheduler::queue_cond;
+
+uint32_t MysqlScheduler::threads_count = 0;
+// Same as eio default
+uint32_t MysqlScheduler::threads_target = 4;
+uint32_t MysqlScheduler::threads_busy = 0;
+
+ev_async MysqlScheduler::done_watcher;
+
+Persistent<Function> MysqlScheduler::bind_function;
+
+void MysqlScheduler::Init(Handle<Object> target) {
+    HandleScope scope;
+
+    // Must be done before any thread uses libmysqlclient
+    mysql_library_init(0, NULL, NULL);
+
+    pthread_mutex_init(&queue_lock, NULL);
+    pthread_cond_init(&queue_cond, NULL);
+
+    // Jobs hold event loop themselves
+    ev_async_init(&done_watcher, Done);
+    ev_async_start(EV_DEFAULT_UC, &done_watcher);
+    ev_unref(EV_DEFAULT_UC);
+
+    Local<Object> js_scheduler = Object::New();
+
+    // Methods
+    js_scheduler->Set(V8STR("setLowPriorityLimitSync"),
+        FunctionTemplate::New(SetLowPriorityLimitSync)->GetFunction());
+    js_scheduler->Set(V8STR("setThreadPoolSizeSync"),
+        FunctionTemplate::New(SetThreadPoolSizeSync)->GetFunction());
+    js_scheduler->Set(V8STR("statsSync"),
+        FunctionTemplate::New(StatsSync)->GetFunction());
+
+    // Priorities accepted by priority options
+    js_scheduler->Set(V8STR("PRIORITY_MIN"), Integer::New(EIO_PRI_MIN));
+    js_scheduler->Set(V8STR("PRIORITY_DEFAULT"), Integer::New(EIO_PRI_DEFAULT));
+    js_scheduler->Set(V8STR("PRIORITY_MAX"), Integer::New(EIO_PRI_MAX));
+
+    // Closure gets data as first argument of native callback
+    bind_function = Persistent<Function>::New(Local<Function>::Cast(
+        Script::Compile(V8STR(
+            "(function (callback, data) {"
+            "  return function () {"
+            "    var args = Array.prototype.slice.call(arguments);"
+            "    args.unshift(data);"
+            "    return callback.apply(this, args);"
+            "  };"
+            "})"), V8STR("mysql_bindings_scheduler"))->Run()));
+
+    // Make it visible in JavaScript
+    target->Set(String::NewSymbol("MysqlScheduler"), js_scheduler);
+}
+
+/**
+ * Binds data to native callback made once in Init, native callback
+ * gets data as args[0] and then arguments of the call
+ *
+ * @ignore
+ */
+Local<Function> MysqlScheduler::BindCallback(Handle<Function> callback,
+                                             Handle<Value> data) {
+    HandleScope scope;
+
+    Local<Value> argv[2];
+    argv[0] = Local<Value>::New(callback);
+    argv[1] = Local<Value>::New(data);
+
+    return scope.Close(Local<Function>::Cast(
+        bind_function->Call(Context::GetCurrent()->Global(), 2, argv)));
+}
+
+/**
+ * Reads priority argument or option, false if it is out of range
+ *
+ * @ignore
+ */
+bool MysqlScheduler::PriorityArg(Handle<Value> js_priority, int *priority) {
+    if (!js_priority->IsNumber()) {
+        return false;
+    }
+
+    int32_t value = js_priority->Int32Value();
+    if (value < EIO_PRI_MIN || value > EIO_PRI_MAX) {
+        return false;
+    }
+
+    *priority = value;
+    return true;
+}
+
+/**
+ * Queues job to thread pool, low priority jobs over the limit wait
+ * until one of running low priority jobs finishes
+ *
+ * @ignore
+ */
+void MysqlScheduler::Submit(int (*execute)(eio_req *),
+                            int (*after)(eio_req *),
+                            int priority, void *data) {
+    struct job *job = reinterpret_cast<struct job *>(
+        calloc(1, sizeof(struct job)));
+
+    if (!job) {
+        // Lose own pool rather than the job
+        eio_custom(execute, priority, after, data);
+        return;
+    }
+
+    job->execute = execute;
+    job->after = after;
+    job->req.data = data;
+    job->priority = priority;
+    job->low_priority = priority < EIO_PRI_DEFAULT;
+
+    if (job->low_priority && low_priority_limit &&
+        low_priority_running >= low_priority_limit) {
+        if (pending_tail) {
+            pending_tail->next = job;
+        } else {
+            pending_head = job;
+        }
+        pending_tail = job;
+        pending_count++;
+        return;
+    }
+
+    Dispatch(job);
+}
+
+void MysqlScheduler::Dispatch(struct job *job) {
+    int lane = job->priority - EIO_PRI_MIN;
+
+    if (job->low_priority) {
+        low_priority_running++;
+    }
+
+    pthread_mutex_lock(&queue_lock);
+
+    if (queue_tail[lane]) {
+        queue_tail[lane]->next = job;
+    } else {
+        queue_head[lane] = job;
+    }
+    queue_tail[lane] = job;
+    queue_length++;
+
+    StartThreads();
+
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+/**
+ * Starts pending low priority jobs while limit allows
+ *
+ * @ignore
+ */
+void MysqlScheduler::DispatchPending() {
+    while (pending_head && (!low_priority_limit ||
+                            low_priority_running < low_priority_limit)) {
+        struct job *next = pending_head;
+        pending_head = next->next;
+        if (!pending_head) {
+            pending_tail = NULL;
+        }
+        pending_count--;
+        next->next = NULL;
+
+        Dispatch(next);
+    }
+}
+
+/**
+ * Starts threads up to pool size, queue_lock must be held
+ *
+ * @ignore
+ */
+void MysqlScheduler::StartThreads() {
+    while (threads_count < threads_target) {
+        pthread_t thread;
+        pthread_attr_t attr;
+
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        int r = pthread_create(&thread, &attr, Worker, NULL);
+        pthread_attr_destroy(&attr);
+
+        if (r) {
+            // Running threads will take the jobs
+            break;
+        }
+        threads_count++;
+    }
+}
+
+/**
+ * Thread pool worker, takes jobs with highest priority first
+ *
+ * @ignore
+ */
+void *MysqlScheduler::Worker(void *arg) {
+    mysql_thread_init();
+
+    pthread_mutex_lock(&queue_lock);
+
+    for (;;) {
+        while (!queue_length && threads_count <= threads_target) {
+            pthread_cond_wait(&queue_cond, &queue_lock);
+        }
+
+        // Pool was shrunk
+        if (threads_count > threads_target) {
+            threads_count--;
+            break;
+        }
+
+        struct job *job = NULL;
+        for (int lane = EIO_PRI_MAX - EIO_PRI_MIN; lane >= 0; lane--) {
+            if (queue_head[lane]) {
+                job = queue_head[lane];
+                queue_head[lane] = job->next;
+                if (!queue_head[lane]) {
+                    queue_tail[lane] = NULL;
+                }
+                break;
+            }
+        }
+        queue_length--;
+        threads_busy++;
+        job->next = NULL;
+
+        pthread_mutex_unlock(&queue_lock);
+
+        job->execute(&job->req);
+
+        pthread_mutex_lock(&queue_lock);
+
+        threads_busy--;
+        if (done_tail) {
+            done_tail->next = job;
+        } else {
+            done_head = job;
+        }
+        done_tail = job;
+
+        ev_async_send(EV_DEFAULT_UC, &done_watcher);
+    }
+
+    pthread_mutex_unlock(&queue_lock);
+
+    mysql_thread_end();
+
+    return NULL;
+}
+
+/**
+ * Runs after callbacks of finished jobs in main thread
+ *
+ * @ignore
+ */
+void MysqlScheduler::Done(EV_P_ ev_async *watcher, int revents) {
+    pthread_mutex_lock(&queue_lock);
+    struct job *job = done_head;
+    done_head = NULL;
+    done_tail = NULL;
+    pthread_mutex_unlock(&queue_lock);
+
+    while (job) {
+        struct job *next = job->next;
+
+        job->after(&job->req);
+
+        if (job->low_priority) {
+            low_priority_running--;
+        }
+        free(job);
+
+        job = next;
+    }
+
+    DispatchPending();
+}
+
+/**
+ * Sets how many low priority jobs may run at once, 0 for no limit
+ *
+ * @param {Integer} limit
+ */
+Handle<Value> MysqlScheduler::SetLowPriorityLimitSync(const Arguments& args) {
+    HandleScope scope;
+
+    REQ_INT_ARG(0, limit);
+
+    if (limit < 0) {
+        return THRTYPEEXC("Limit must be non-negative");
+    }
+
+    low_priority_limit = limit;
+
+    // Raised limit may let pending jobs start
+    DispatchPending();
+
+    return Undefined();
+}
+
+/**
+ * Sets number of threads for database work, busy threads
+ * finish their jobs before pool shrinks
+ *
+ * @param {Integer} size
+ */
+Handle<Value> MysqlScheduler::SetThreadPoolSizeSync(const Arguments& args) {
+    HandleScope scope;
+
+    REQ_INT_ARG(0, size);
+
+    if (size < 1) {
+        return THRTYPEEXC("Thread pool size must be positive");
+    }
+
+    pthread_mutex_lock(&queue_lock);
+
+    threads_target = size;
+    if (queue_length) {
+        StartThreads();
+    }
+
+    // Extra idle threads wake up and exit
+    pthread_cond_broadcast(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+
+    return Undefined();
+}
+
+/**
+ * Returns thread pool and low priority jobs gauges
+ *
+ * @return {Object} {threads, busyThreads, queueLength, lowPriorityRunning,
+ *                   lowPriorityQueued, lowPriorityLimit}
+ */
+Handle<Value> MysqlScheduler::StatsSync(const Arguments& args) {
+    HandleScope scope;
+
+    Local<Object> js_stats = Object::New();
+
+    pthread_mutex_lock(&queue_lock);
+    uint32_t threads = threads_count;
+    uint32_t busy = threads_busy;
+    uint32_t length = queue_length;
+    pthread_mutex_unlock(&queue_lock);
+
+    js_stats->Set(V8STR("threads"), Integer::NewFromUnsigned(threads));
+    js_stats->Set(V8STR("busyThreads"), Integer::NewFromUnsigned(busy));
+    js_stats->Set(V8STR("queueLength"), Integer::NewFromUnsigned(length));
+    js_stats->Set(V8STR("lowPriorityRunning"),
+                  Integer::NewFromUnsigned(low_priority_running));
+    js_stats->Set(V8STR("lowPriorityQueued"),
+                  Integer::NewFromUnsigned(pending_count));
+    js_stats->Set(V8STR("lowPriorityLimit"),
+                  Integer::NewFromUnsigned(low_priority_limit));
+
+    return scope.Close(js_stats);
+}
+
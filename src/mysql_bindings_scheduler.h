@@ -0,0 +1,103 @@
+/*
+Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+See contributors list in README
+
+See license text in LICENSE file
+*/
+
+#ifndef NODE_MYSQL_SCHEDULER_H  // NOLINT
+#define NODE_MYSQL_SCHEDULER_H
+
+#include <mysql.h>
+
+#include <v8.h>
+#include <node.h>
+
+#include <pthread.h>
+
+#include "./mysql_bindings.h"
+
+using namespace v8; // NOLINT
+
+/**
+ * Runs asynchronous jobs on own thread pool, so database work doesn't
+ * share eio threads with filesystem and DNS calls. Jobs take the
+ * highest priority first, low priority ones are also limited so batch
+ * work can't take all threads
+ */
+class MysqlScheduler {
+  public:
+    static void Init(Handle<Object> target);
+
+    static void Submit(int (*execute)(eio_req *),
+                       int (*after)(eio_req *),
+                       int priority, void *data);
+
+    static bool PriorityArg(Handle<Value> js_priority, int *priority);
+
+    static Local<Function> BindCallback(Handle<Function> callback,
+                                        Handle<Value> data);
+
+  protected:
+    // Makes closures passing data to native callbacks, functions
+    // of FunctionTemplate are never collected, so they are made once
+    static Persistent<Function> bind_function;
+
+    struct job {
+        int (*execute)(eio_req *);
+        int (*after)(eio_req *);
+        // Wrapped functions get their data in eio-like request
+        eio_req req;
+        int priority;
+        bool low_priority;
+        struct job *next;
+    };
+
+    // Pending low priority jobs over the limit, FIFO, main thread only
+    static struct job *pending_head;
+    static struct job *pending_tail;
+    static uint32_t pending_count;
+
+    static uint32_t low_priority_running;
+    static uint32_t low_priority_limit;
+
+    // Jobs waiting for thread, FIFO for each priority
+    static struct job *queue_head[EIO_PRI_MAX - EIO_PRI_MIN + 1];
+    static struct job *queue_tail[EIO_PRI_MAX - EIO_PRI_MIN + 1];
+    static uint32_t queue_length;
+
+    // Finished jobs waiting for after callback
+    static struct job *done_head;
+    static struct job *done_tail;
+
+    // Protects queues and threads counters
+    static pthread_mutex_t queue_lock;
+    static pthread_cond_t queue_cond;
+
+    static uint32_t threads_count;
+    static uint32_t threads_target;
+    static uint32_t threads_busy;
+
+    static ev_async done_watcher;
+
+    static void Dispatch(struct job *job);
+
+    static void DispatchPending();
+
+    static void StartThreads();
+
+    static void *Worker(void *arg);
+
+    static void Done(EV_P_ ev_async *watcher, int revents);
+
+    // Methods
+
+    static Handle<Value> SetLowPriorityLimitSync(const Arguments& args);
+
+    static Handle<Value> SetThreadPoolSizeSync(const Arguments& args);
+
+    static Handle<Value> StatsSync(const Arguments& args);
+};
+
+#endif  // NODE_MYSQL_SCHEDULER_H  // NOLINT
+
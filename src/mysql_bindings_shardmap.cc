@@ -0,0 +1,1125 @@
+/*!
+ * Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+ * See contributors list in README
+ *
+ * See license text in LICENSE file
+ */
+
+/**
+ * Include headers
+ *
+ * @ignore
+ */
+#include "./mysql_bindings_connection.h"
+#include "./mysql_bindings_result.h"
+#include "./mysql_bindings_shardmap.h"
+
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * Init V8 structures for MysqlShardMap class
+ *
+ * @ignore
+ */
+Persistent<FunctionTemplate> MysqlShardMap::constructor_template;
+
+void MysqlShardMap::Init(Handle<Object> target) {
+    HandleScope scope;
+
+    Local<FunctionTemplate> t = FunctionTemplate::New(New);
+
+    // Constructor
+    constructor_template = Persistent<FunctionTemplate>::New(t);
+    constructor_template->Inherit(EventEmitter::constructor_template);
+    constructor_template->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor_template->SetClassName(String::NewSymbol("MysqlShardMap"));
+
+    // Methods
+    ADD_PROTOTYPE_METHOD(shardmap, query, Query);
+    ADD_PROTOTYPE_METHOD(shardmap, querySync, QuerySync);
+    ADD_PROTOTYPE_METHOD(shardmap, scatter, ScatterShards);
+    ADD_PROTOTYPE_METHOD(shardmap, setRangesSync, SetRangesSync);
+    ADD_PROTOTYPE_METHOD(shardmap, setWeightsSync, SetWeightsSync);
+    ADD_PROTOTYPE_METHOD(shardmap, shardSync, ShardSync);
+
+    // Static methods
+    Local<Function> js_constructor = constructor_template->GetFunction();
+    js_constructor->Set(V8STR("scatter"),
+        FunctionTemplate::New(Scatter)->GetFunction());
+
+    // Make it visible in JavaScript
+    target->Set(String::NewSymbol("MysqlShardMap"), js_constructor);
+}
+
+MysqlShardMap::MysqlShardMap(): EventEmitter() {
+    shards_count = 0;
+    ring = NULL;
+    ring_size = 0;
+    range_starts = NULL;
+}
+
+MysqlShardMap::~MysqlShardMap() {
+    shards.Dispose();
+    free(ring);
+    free(range_starts);
+}
+
+/**
+ * Murmur3 finalizer, spreads FNV hashes over the ring
+ *
+ * @ignore
+ */
+uint32_t MysqlShardMap::Mix(uint32_t hash) {
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bU;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35U;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+uint32_t MysqlShardMap::HashKey(const char *key, size_t length) {
+    // FNV-1a
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(key[i]);
+        hash *= 16777619U;
+    }
+
+    return Mix(hash);
+}
+
+int MysqlShardMap::CompareRingPoints(const void *a, const void *b) {
+    const struct ring_point *x = static_cast<const struct ring_point *>(a);
+    const struct ring_point *y = static_cast<const struct ring_point *>(b);
+
+    if (x->hash != y->hash) {
+        return x->hash < y->hash ? -1 : 1;
+    }
+
+    return x->shard < y->shard ? -1 : (x->shard > y->shard);
+}
+
+/**
+ * Rebuilds ring from shard weights, points of each shard don't depend
+ * on other shards, so only keys of changed shards move
+ *
+ * @ignore
+ */
+bool MysqlShardMap::BuildRing(Local<Array> js_weights) {
+    uint32_t size = 0;
+
+    for (uint32_t i = 0; i < shards_count; i++) {
+        size += js_weights->Get(Integer::New(i))->Uint32Value()*
+                SHARDMAP_POINTS_PER_WEIGHT;
+    }
+
+    struct ring_point *points = reinterpret_cast<struct ring_point *>(
+        malloc((size + 1)*sizeof(struct ring_point)));
+
+    if (!points) {
+        return false;
+    }
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < shards_count; i++) {
+        uint32_t count = js_weights->Get(Integer::New(i))->Uint32Value()*
+                         SHARDMAP_POINTS_PER_WEIGHT;
+
+        for (uint32_t j = 0; j < count; j++) {
+            uint32_t id[2] = {i, j};
+            points[n].hash = HashKey(reinterpret_cast<const char *>(id),
+                                     sizeof(id));
+            points[n].shard = i;
+            n++;
+        }
+    }
+
+    qsort(points, size, sizeof(struct ring_point), CompareRingPoints);
+
+    free(ring);
+    ring = points;
+    ring_size = size;
+
+    return true;
+}
+
+/**
+ * Finds shard index for key, -1 with error message if there is none
+ *
+ * @ignore
+ */
+int32_t MysqlShardMap::Route(Handle<Value> js_key, const char **error) {
+    if (range_starts) {
+        if (!js_key->IsNumber()) {
+            *error = "Key must be a number when ranges are set";
+            return -1;
+        }
+
+        double key = js_key->NumberValue();
+
+        if (key < range_starts[0]) {
+            *error = "Key is below the first shard range";
+            return -1;
+        }
+
+        // Last range starting at or before key
+        uint32_t low = 0, high = shards_count;
+        while (high - low > 1) {
+            uint32_t middle = low + (high - low)/2;
+            if (range_starts[middle] <= key) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+
+        return low;
+    }
+
+    if (!js_key->IsString() && !js_key->IsNumber()) {
+        *error = "Key must be a string or number";
+        return -1;
+    }
+
+    if (!ring_size) {
+        *error = "No shards with positive weight";
+        return -1;
+    }
+
+    String::Utf8Value key(js_key->ToString());
+    uint32_t hash = HashKey(*key, key.length());
+
+    // First point at or after key hash, wrapping around
+    uint32_t low = 0, high = ring_size;
+    while (low < high) {
+        uint32_t middle = low + (high - low)/2;
+        if (ring[middle].hash < hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return ring[low == ring_size ? 0 : low].shard;
+}
+
+/**
+ * Calls method of key shard with the rest of arguments
+ *
+ * @ignore
+ */
+Handle<Value> MysqlShardMap::RouteAndCall(const Arguments& args,
+                                          const char *method) {
+    if (args.Length() < 1) {
+        return THRTYPEEXC("Argument 0 must be a shard key");
+    }
+
+    const char *error = NULL;
+    int32_t shard = Route(args[0], &error);
+
+    if (shard < 0) {
+        return THREXC(error);
+    }
+
+    Local<Object> js_shard = shards->Get(Integer::New(shard))->ToObject();
+
+    Local<Value> js_method = js_shard->Get(V8STR(method));
+    if (!js_method->IsFunction()) {
+        return THRTYPEEXC("Shard has no such method");
+    }
+
+    // Arguments are passed as is, so callback is called by shard directly
+    int argc = args.Length() - 1;
+    Local<Value> *argv = new Local<Value>[argc + 1];
+    for (int i = 0; i < argc; i++) {
+        argv[i] = args[i + 1];
+    }
+
+    Local<Value> js_result = Local<Function>::Cast(js_method)->
+        Call(js_shard, argc, argv);
+
+    delete[] argv;
+
+    return js_result;
+}
+
+/**
+ * Creates new MysqlShardMap object, keys are distributed
+ * by consistent hashing until ranges are set
+ *
+ * @constructor
+ * @param {Array} shard connections or pools, scatter() works
+ *                with connections only
+ * @param {Array|null} weights of shards up to 1000, 1 for each by default
+ */
+Handle<Value> MysqlShardMap::New(const Arguments& args) {
+    HandleScope scope;
+
+    if (args.Length() < 1 || !args[0]->IsArray()) {
+        return THRTYPEEXC("Argument 0 must be an array of connections");
+    }
+
+    Local<Array> js_shards = Local<Array>::Cast(args[0]);
+
+    if (!js_shards->Length()) {
+        return THRTYPEEXC("Argument 0 must be an array of connections");
+    }
+
+    for (uint32_t i = 0; i < js_shards->Length(); i++) {
+        if (!js_shards->Get(Integer::New(i))->IsObject()) {
+            return THRTYPEEXC("Argument 0 must be an array of connections");
+        }
+    }
+
+    Local<Array> js_weights;
+    if (args.Length() > 1 && !args[1]->IsNull() && !args[1]->IsUndefined()) {
+        if (!args[1]->IsArray() ||
+            Local<Array>::Cast(args[1])->Length() != js_shards->Length()) {
+            return THRTYPEEXC("Argument 1 must be an array of weights");
+        }
+        js_weights = Local<Array>::Cast(args[1]);
+
+        for (uint32_t i = 0; i < js_weights->Length(); i++) {
+            Local<Value> js_weight = js_weights->Get(Integer::New(i));
+            if (!js_weight->IsUint32() ||
+                js_weight->Uint32Value() > SHARDMAP_MAX_WEIGHT) {
+                return THRTYPEEXC("Argument 1 must be an array of weights");
+            }
+        }
+    } else {
+        js_weights = Array::New(js_shards->Length());
+        for (uint32_t i = 0; i < js_shards->Length(); i++) {
+            js_weights->Set(Integer::New(i), Integer::New(1));
+        }
+    }
+
+    // Private copy, so changes to this.shards can't leave holes in it
+    Local<Array> js_shards_copy = Array::New(js_shards->Length());
+    for (uint32_t i = 0; i < js_shards->Length(); i++) {
+        js_shards_copy->Set(Integer::New(i), js_shards->Get(Integer::New(i)));
+    }
+
+    MysqlShardMap *shardmap = new MysqlShardMap();
+
+    shardmap->shards = Persistent<Array>::New(js_shards_copy);
+    shardmap->shards_count = js_shards_copy->Length();
+
+    if (!shardmap->BuildRing(js_weights)) {
+        delete shardmap;
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    shardmap->Wrap(args.This());
+
+    args.This()->Set(V8STR("shards"), js_shards);
+
+    return args.This();
+}
+
+/**
+ * Performs query asynchronously on shard of the key
+ *
+ * @param {String|Number} key
+ * @param {String} query
+ * @param {Object|null} options passed to shard query()
+ * @param {Function(error, result)} callback
+ */
+Handle<Value> MysqlShardMap::Query(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlShardMap *shardmap = OBJUNWRAP<MysqlShardMap>(args.This());
+
+    if (args.Length() < 3 || !args[args.Length() - 1]->IsFunction()) {
+        return THRTYPEEXC("Last argument must be a function");
+    }
+
+    Handle<Value> js_result = shardmap->RouteAndCall(args, "query");
+
+    return scope.Close(js_result);
+}
+
+/**
+ * Performs query synchronously on shard of the key
+ *
+ * @param {String|Number} key
+ * @param {String} query
+ * @return {MysqlResult|Boolean}
+ */
+Handle<Value> MysqlShardMap::QuerySync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlShardMap *shardmap = OBJUNWRAP<MysqlShardMap>(args.This());
+
+    Handle<Value> js_result = shardmap->RouteAndCall(args, "querySync");
+
+    return scope.Close(js_result);
+}
+
+/**
+ * EIO wrapper functions for MysqlShardMap::Scatter
+ */
+#ifndef MYSQL_NON_THREADSAFE
+int MysqlShardMap::CompareDecimals(const char *a, unsigned long a_length,  // NOLINT
+                                   const char *b, unsigned long b_length) {  // NOLINT
+    // Exact, strtod() would round digits after 15th
+    const char *a_end = a + a_length, *b_end = b + b_length;
+    bool a_negative = a < a_end && *a == '-';
+    bool b_negative = b < b_end && *b == '-';
+    if (a_negative || (a < a_end && *a == '+')) {
+        a++;
+    }
+    if (b_negative || (b < b_end && *b == '+')) {
+        b++;
+    }
+    while (a < a_end && *a == '0') {
+        a++;
+    }
+    while (b < b_end && *b == '0') {
+        b++;
+    }
+
+    const char *a_point = static_cast<const char *>(memchr(a, '.', a_end - a));
+    const char *b_point = static_cast<const char *>(memchr(b, '.', b_end - b));
+    if (!a_point) {
+        a_point = a_end;
+    }
+    if (!b_point) {
+        b_point = b_end;
+    }
+
+    // Magnitudes compare by integer part length, then digit by digit
+    int r = (a_point - a) < (b_point - b) ? -1 : ((a_point - a) > (b_point - b));
+    if (!r) {
+        r = memcmp(a, b, a_point - a);
+    }
+    for (const char *x = a_point + (a_point < a_end),
+                    *y = b_point + (b_point < b_end);
+         !r && (x < a_end || y < b_end); x++, y++) {
+        char dx = x < a_end ? *x : '0', dy = y < b_end ? *y : '0';
+        r = dx < dy ? -1 : (dx > dy);
+    }
+    r = r < 0 ? -1 : (r > 0);
+
+    // -0.00 equals 0
+    bool a_zero = true, b_zero = true;
+    for (const char *x = a; x < a_end && a_zero; x++) {
+        a_zero = *x == '0' || *x == '.';
+    }
+    for (const char *y = b; y < b_end && b_zero; y++) {
+        b_zero = *y == '0' || *y == '.';
+    }
+    a_negative = a_negative && !a_zero;
+    b_negative = b_negative && !b_zero;
+
+    if (a_negative != b_negative) {
+        return a_negative ? -1 : 1;
+    }
+    return a_negative ? -r : r;
+}
+
+int MysqlShardMap::CompareScatterValues(MYSQL_FIELD *field,
+                                        const char *a,
+                                        unsigned long a_length,  // NOLINT
+                                        const char *b,
+                                        unsigned long b_length) {  // NOLINT
+    // NULL goes first, as in MySQL
+    if (!a || !b) {
+        return a ? 1 : (b ? -1 : 0);
+    }
+
+    switch (field->type) {
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_LONGLONG:
+        case MYSQL_TYPE_YEAR:
+            if (field->flags & UNSIGNED_FLAG) {
+                uint64_t x = strtoull(a, NULL, 10), y = strtoull(b, NULL, 10);
+                return x < y ? -1 : (x > y);
+            } else {
+                int64_t x = strtoll(a, NULL, 10), y = strtoll(b, NULL, 10);
+                return x < y ? -1 : (x > y);
+            }
+        case MYSQL_TYPE_DECIMAL:
+        case MYSQL_TYPE_NEWDECIMAL:
+            return CompareDecimals(a, a_length, b, b_length);
+        case MYSQL_TYPE_FLOAT:
+        case MYSQL_TYPE_DOUBLE:
+            {
+                double x = strtod(a, NULL), y = strtod(b, NULL);
+                return x < y ? -1 : (x > y);
+            }
+        default:
+            // Dates have sortable text form, strings are binary or _bin
+            // ones, see IsScatterOrderable()
+            {
+                unsigned long length = a_length < b_length ?  // NOLINT
+                                       a_length : b_length;
+                int r = memcmp(a, b, length);
+                if (r) {
+                    return r < 0 ? -1 : 1;
+                }
+                if (field->charsetnr != 63) {
+                    // PAD SPACE, longer value is compared to spaces
+                    const char *rest = a_length > b_length ? a : b;
+                    unsigned long rest_length = a_length > b_length ?  // NOLINT
+                                                a_length : b_length;
+                    for (; length < rest_length; length++) {
+                        unsigned char c = rest[length];
+                        if (c != ' ') {
+                            r = c < ' ' ? -1 : 1;
+                            return a_length > b_length ? r : -r;
+                        }
+                    }
+                    return 0;
+                }
+                return a_length < b_length ? -1 : (a_length > b_length);
+            }
+    }
+}
+
+/**
+ * Checks if comparison above gives the order server sorted rows in
+ *
+ * @ignore
+ */
+bool MysqlShardMap::IsScatterOrderable(MYSQL_FIELD *field) {
+    switch (field->type) {
+        case MYSQL_TYPE_VARCHAR:
+        case MYSQL_TYPE_VAR_STRING:
+        case MYSQL_TYPE_STRING:
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB:
+        case MYSQL_TYPE_BLOB:
+        case MYSQL_TYPE_ENUM:
+        case MYSQL_TYPE_SET:
+            // ENUM and SET sort by index, other collations by weights
+            if (field->flags & (ENUM_FLAG | SET_FLAG)) {
+                return false;
+            }
+            return field->charsetnr == 63 || (field->flags & BINARY_FLAG);
+        default:
+            return true;
+    }
+}
+
+int MysqlShardMap::CompareScatterRows(struct scatter_request *scatter,
+                                      MYSQL_FIELD *fields,
+                                      MYSQL_ROW *current,
+                                      unsigned long **current_lengths,  // NOLINT
+                                      uint32_t a, uint32_t b) {
+    for (uint32_t i = 0; i < scatter->order_count; i++) {
+        int32_t j = scatter->order[i].index;
+        int r = CompareScatterValues(&fields[j],
+                                     current[a][j], current_lengths[a][j],
+                                     current[b][j], current_lengths[b][j]);
+        if (r) {
+            return scatter->order[i].desc ? -r : r;
+        }
+    }
+
+    // Equal rows keep shards order
+    return a < b ? -1 : (a > b);
+}
+
+/**
+ * Merges sorted shard results with k-way merge by order columns,
+ * runs in the worker that finished last
+ *
+ * @ignore
+ */
+void MysqlShardMap::MergeScatter(struct scatter_request *scatter) {
+    uint32_t k = scatter->conns_count;
+    MYSQL_FIELD *fields = mysql_fetch_fields(scatter->results[0]);
+    uint32_t fields_count = mysql_num_fields(scatter->results[0]);
+    uint64_t total = 0;
+
+    for (uint32_t i = 0; i < k; i++) {
+        if (mysql_num_fields(scatter->results[i]) != fields_count) {
+            scatter->error = strdup("Shards returned different columns");
+            return;
+        }
+        total += mysql_num_rows(scatter->results[i]);
+    }
+
+    for (uint32_t i = 0; i < scatter->order_count; i++) {
+        scatter->order[i].index = -1;
+        for (uint32_t j = 0; j < fields_count; j++) {
+            if (!strcmp(fields[j].name, scatter->order[i].column)) {
+                scatter->order[i].index = j;
+                break;
+            }
+        }
+        if (scatter->order[i].index < 0) {
+            scatter->error = strdup("Order column is not in result");
+            return;
+        }
+        if (!IsScatterOrderable(&fields[scatter->order[i].index])) {
+            scatter->error = strdup("Order column must not be ENUM, SET or "
+                                    "string with collation other than _bin");
+            return;
+        }
+    }
+
+    if (scatter->limit && scatter->limit < total) {
+        total = scatter->limit;
+    }
+
+    scatter->fields_count = fields_count;
+    scatter->rows = reinterpret_cast<MYSQL_ROW *>(
+        malloc((total + 1)*sizeof(MYSQL_ROW)));
+    scatter->lengths = reinterpret_cast<unsigned long *>(  // NOLINT
+        malloc((total*fields_count + 1)*sizeof(unsigned long)));  // NOLINT
+    MYSQL_ROW *current = reinterpret_cast<MYSQL_ROW *>(
+        malloc(k*sizeof(MYSQL_ROW)));
+    unsigned long **current_lengths = reinterpret_cast<unsigned long **>(  // NOLINT
+        malloc(k*sizeof(unsigned long *)));  // NOLINT
+    uint32_t *heap = reinterpret_cast<uint32_t *>(malloc(k*sizeof(uint32_t)));
+
+    if (!scatter->rows || !scatter->lengths || !current ||
+        !current_lengths || !heap) {
+        free(current);
+        free(current_lengths);
+        free(heap);
+        scatter->error = strdup("Could not allocate enough memory");
+        return;
+    }
+
+    // Heap of shards by their current row, smallest on top
+    uint32_t heap_size = 0;
+    for (uint32_t i = 0; i < k; i++) {
+        current[i] = mysql_fetch_row(scatter->results[i]);
+        if (!current[i]) {
+            continue;
+        }
+        current_lengths[i] = mysql_fetch_lengths(scatter->results[i]);
+
+        uint32_t child = heap_size++;
+        while (child > 0) {
+            uint32_t parent = (child - 1)/2;
+            if (CompareScatterRows(scatter, fields, current, current_lengths,
+                                   heap[parent], i) <= 0) {
+                break;
+            }
+            heap[child] = heap[parent];
+            child = parent;
+        }
+        heap[child] = i;
+    }
+
+    uint32_t n = 0;
+    while (heap_size && n < total) {
+        uint32_t top = heap[0];
+
+        scatter->rows[n] = current[top];
+        memcpy(scatter->lengths + n*fields_count, current_lengths[top],
+               fields_count*sizeof(unsigned long));  // NOLINT
+        n++;
+
+        current[top] = mysql_fetch_row(scatter->results[top]);
+        if (current[top]) {
+            current_lengths[top] = mysql_fetch_lengths(scatter->results[top]);
+        } else {
+            top = heap[--heap_size];
+        }
+
+        // Sift down shard at the top
+        uint32_t parent = 0;
+        while (heap_size) {
+            uint32_t child = 2*parent + 1;
+            if (child >= heap_size) {
+                break;
+            }
+            if (child + 1 < heap_size &&
+                CompareScatterRows(scatter, fields, current, current_lengths,
+                                   heap[child + 1], heap[child]) < 0) {
+                child++;
+            }
+            if (CompareScatterRows(scatter, fields, current, current_lengths,
+                                   top, heap[child]) <= 0) {
+                break;
+            }
+            heap[parent] = heap[child];
+            parent = child;
+        }
+        if (heap_size) {
+            heap[parent] = top;
+        }
+    }
+    scatter->rows_count = n;
+
+    free(current);
+    free(current_lengths);
+    free(heap);
+}
+
+void MysqlShardMap::FreeScatter(struct scatter_request *scatter) {
+    for (uint32_t i = 0; i < scatter->conns_count; i++) {
+        if (scatter->results[i]) {
+            mysql_free_result(scatter->results[i]);
+        }
+        free(scatter->errors[i]);
+    }
+    for (uint32_t i = 0; i < scatter->order_count; i++) {
+        free(scatter->order[i].column);
+    }
+    scatter->callback.Dispose();
+    pthread_mutex_destroy(&scatter->lock);
+    free(scatter->query);
+    free(scatter->conns);
+    free(scatter->results);
+    free(scatter->errors);
+    free(scatter->order);
+    free(scatter->rows);
+    free(scatter->lengths);
+    free(scatter->error);
+    free(scatter);
+}
+
+int MysqlShardMap::EIO_After_Scatter(eio_req *req) {
+    ev_unref(EV_DEFAULT_UC);
+    HandleScope scope;
+    struct scatter_job *job = reinterpret_cast<struct scatter_job *>(req->data);
+    struct scatter_request *scatter = job->scatter;
+
+    scatter->conns[job->index]->Unref();
+    free(job);
+
+    if (--scatter->pending) {
+        return 0;
+    }
+
+    int argc = 1;
+    Local<Value> argv[2];
+
+    int32_t error_shard = -1;
+    for (uint32_t i = 0; i < scatter->conns_count; i++) {
+        if (scatter->errors[i]) {
+            error_shard = i;
+            break;
+        }
+    }
+
+    if (error_shard >= 0) {
+        argv[0] = V8EXC(scatter->errors[error_shard]);
+        argv[0]->ToObject()->Set(V8STR("shard"), Integer::New(error_shard));
+    } else if (scatter->error) {
+        argv[0] = V8EXC(scatter->error);
+    } else {
+        MYSQL_FIELD *fields = mysql_fetch_fields(scatter->results[0]);
+        Local<Array> js_rows = Array::New(scatter->rows_count);
+
+        for (uint32_t i = 0; i < scatter->rows_count; i++) {
+            Local<Object> js_row = Object::New();
+
+            for (uint32_t j = 0; j < scatter->fields_count; j++) {
+                js_row->Set(V8STR(fields[j].name),
+                    MysqlResult::GetFieldValue(fields[j],
+                        scatter->rows[i][j],
+                        scatter->lengths[i*scatter->fields_count + j]));
+            }
+
+            js_rows->Set(Integer::New(i), js_row);
+        }
+
+        argv[0] = Local<Value>::New(Null());
+        argv[1] = js_rows;
+        argc = 2;
+    }
+
+    TryCatch try_catch;
+
+    scatter->callback->Call(Context::GetCurrent()->Global(), argc, argv);
+
+    if (try_catch.HasCaught()) {
+        node::FatalException(try_catch);
+    }
+
+    FreeScatter(scatter);
+
+    return 0;
+}
+
+int MysqlShardMap::EIO_Scatter(eio_req *req) {
+    struct scatter_job *job = reinterpret_cast<struct scatter_job *>(req->data);
+    struct scatter_request *scatter = job->scatter;
+    MysqlConnection *conn = scatter->conns[job->index];
+
+    req->result = 0;
+
+    pthread_mutex_lock(&conn->query_lock);
+
+    if (!conn->_conn) {
+        scatter->errors[job->index] = strdup("Not connected");
+    } else if (conn->ExecuteQuery(scatter->query, scatter->query_length)) {
+        scatter->errors[job->index] = strdup(conn->_conn ?
+                                             mysql_error(conn->_conn) :
+                                             "Not connected");
+    } else if (!(scatter->results[job->index] =
+                 mysql_store_result(conn->_conn))) {
+        scatter->errors[job->index] = strdup(
+            mysql_field_count(conn->_conn) ? mysql_error(conn->_conn) :
+                                             "Query must return rows");
+    }
+
+    conn->last_activity = ev_time();
+    pthread_mutex_unlock(&conn->query_lock);
+
+    if (scatter->errors[job->index]) {
+        req->result = 1;
+    }
+
+    pthread_mutex_lock(&scatter->lock);
+    bool last = !--scatter->running;
+    pthread_mutex_unlock(&scatter->lock);
+
+    if (!last) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < scatter->conns_count; i++) {
+        if (scatter->errors[i]) {
+            return 0;
+        }
+    }
+
+    MergeScatter(scatter);
+
+    return 0;
+}
+#endif
+
+/**
+ * Parses scatter arguments and submits query to each connection
+ *
+ * @ignore
+ */
+Handle<Value> MysqlShardMap::StartScatter(Local<Value> js_query,
+                                          Local<Value> js_conns,
+                                          Local<Value> js_options,
+                                          Local<Value> js_callback) {
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    if (!js_query->IsString()) {
+        return THRTYPEEXC("Query must be a string");
+    }
+    if (!js_conns->IsArray() || !Local<Array>::Cast(js_conns)->Length()) {
+        return THRTYPEEXC("Connections must be a non-empty array");
+    }
+    if (!js_callback->IsFunction()) {
+        return THRTYPEEXC("Callback must be a function");
+    }
+
+    String::Utf8Value query(js_query);
+
+    Local<Array> js_connections = Local<Array>::Cast(js_conns);
+    uint32_t conns_count = js_connections->Length();
+
+    for (uint32_t i = 0; i < conns_count; i++) {
+        Local<Value> js_conn = js_connections->Get(Integer::New(i));
+
+        if (!MysqlConnection::constructor_template->HasInstance(js_conn)) {
+            return THRTYPEEXC("Connections must be MysqlConnection objects, "
+                              "pools are not supported");
+        }
+        if (!OBJUNWRAP<MysqlConnection>(js_conn->ToObject())->connected) {
+            return THREXC("Not connected");
+        }
+    }
+
+    Local<Array> js_order = Array::New();
+    uint32_t limit = 0;
+
+    if (js_options->IsObject() && !js_options->IsFunction()) {
+        Local<Object> js_opts = js_options->ToObject();
+
+        if (js_opts->Has(V8STR("orderBy"))) {
+            Local<Value> js_order_by = js_opts->Get(V8STR("orderBy"));
+            if (js_order_by->IsString()) {
+                js_order->Set(Integer::New(0), js_order_by);
+            } else if (js_order_by->IsArray()) {
+                js_order = Local<Array>::Cast(js_order_by);
+            } else {
+                return THRTYPEEXC("orderBy must be a string or array");
+            }
+        }
+
+        if (js_opts->Has(V8STR("limit"))) {
+            Local<Value> js_limit = js_opts->Get(V8STR("limit"));
+            if (!js_limit->IsUint32()) {
+                return THRTYPEEXC("limit must be a non-negative integer");
+            }
+            limit = js_limit->Uint32Value();
+        }
+    }
+
+    struct scatter_request *scatter = reinterpret_cast<struct scatter_request *>(
+        calloc(1, sizeof(struct scatter_request)));
+
+    if (!scatter) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    pthread_mutex_init(&scatter->lock, NULL);
+    scatter->conns_count = conns_count;
+    scatter->limit = limit;
+    scatter->query_length = query.length();
+    scatter->query = reinterpret_cast<char *>(malloc(query.length() + 1));
+    scatter->conns = reinterpret_cast<MysqlConnection **>(
+        calloc(conns_count, sizeof(MysqlConnection *)));
+    scatter->results = reinterpret_cast<MYSQL_RES **>(
+        calloc(conns_count, sizeof(MYSQL_RES *)));
+    scatter->errors = reinterpret_cast<char **>(
+        calloc(conns_count, sizeof(char *)));
+    scatter->order = reinterpret_cast<struct scatter_order *>(
+        calloc(js_order->Length() + 1, sizeof(struct scatter_order)));
+
+    if (!scatter->query || !scatter->conns || !scatter->results ||
+        !scatter->errors || !scatter->order) {
+        FreeScatter(scatter);
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    memcpy(scatter->query, *query, query.length() + 1);
+
+    // "column", "column ASC" or "column DESC"
+    for (uint32_t i = 0; i < js_order->Length(); i++) {
+        Local<Value> js_column = js_order->Get(Integer::New(i));
+        if (!js_column->IsString()) {
+            FreeScatter(scatter);
+            return THRTYPEEXC("orderBy columns must be strings");
+        }
+
+        String::Utf8Value column(js_column);
+        size_t length = column.length();
+        struct scatter_order *order = &scatter->order[scatter->order_count++];
+
+        if (length > 5 && !strcasecmp(*column + length - 5, " DESC")) {
+            order->desc = true;
+            length -= 5;
+        } else if (length > 4 && !strcasecmp(*column + length - 4, " ASC")) {
+            length -= 4;
+        }
+        while (length && (*column)[length - 1] == ' ') {
+            length--;
+        }
+
+        order->column = strndup(*column, length);
+        if (!order->column) {
+            FreeScatter(scatter);
+            V8::LowMemoryNotification();
+            return THREXC("Could not allocate enough memory");
+        }
+    }
+
+    struct scatter_job **jobs = reinterpret_cast<struct scatter_job **>(
+        calloc(conns_count, sizeof(struct scatter_job *)));
+    bool allocated = jobs != NULL;
+    for (uint32_t i = 0; allocated && i < conns_count; i++) {
+        jobs[i] = reinterpret_cast<struct scatter_job *>(
+            malloc(sizeof(struct scatter_job)));
+        allocated = jobs[i] != NULL;
+    }
+
+    if (!allocated) {
+        for (uint32_t i = 0; jobs && i < conns_count; i++) {
+            free(jobs[i]);
+        }
+        free(jobs);
+        FreeScatter(scatter);
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    scatter->callback = Persistent<Function>::New(
+        Local<Function>::Cast(js_callback));
+    scatter->running = conns_count;
+    scatter->pending = conns_count;
+
+    for (uint32_t i = 0; i < conns_count; i++) {
+        MysqlConnection *conn = OBJUNWRAP<MysqlConnection>(
+            js_connections->Get(Integer::New(i))->ToObject());
+
+        scatter->conns[i] = conn;
+        jobs[i]->scatter = scatter;
+        jobs[i]->index = i;
+
+        MysqlScheduler::Submit(EIO_Scatter, EIO_After_Scatter,
+                               conn->priority, jobs[i]);
+
+        ev_ref(EV_DEFAULT_UC);
+        conn->Ref();
+    }
+
+    free(jobs);
+
+    return Undefined();
+#endif
+}
+
+/**
+ * Runs query on all connections at once and merges their rows,
+ * each connection must return rows sorted by orderBy columns,
+ * e.g. with the same ORDER BY and LIMIT in the query. Numbers
+ * compare by value, dates and binary or _bin strings bytewise,
+ * NULL goes first. Other strings, ENUM and SET order columns give
+ * an error, each server sorts them in its own way. Pools throw
+ *
+ * @param {String} query
+ * @param {Array} connections
+ * @param {Object|null} options {orderBy: "column [ASC|DESC]" or array
+ *                      of them, limit: rows count, 0 for all}
+ * @param {Function(error, rows)} callback
+ */
+Handle<Value> MysqlShardMap::Scatter(const Arguments& args) {
+    HandleScope scope;
+
+    Local<Value> js_options = args.Length() > 3 ?
+                              args[2] : Local<Value>::New(Undefined());
+    Local<Value> js_callback = args.Length() > 3 ? args[3] : args[2];
+
+    return scope.Close(StartScatter(args[0], args[1],
+                                    js_options, js_callback));
+}
+
+/**
+ * Runs query on all shards at once and merges their rows,
+ * see MysqlShardMap.scatter(), throws if some shard is a pool
+ *
+ * @param {String} query
+ * @param {Object|null} options
+ * @param {Function(error, rows)} callback
+ */
+Handle<Value> MysqlShardMap::ScatterShards(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlShardMap *shardmap = OBJUNWRAP<MysqlShardMap>(args.This());
+
+    Local<Value> js_options = args.Length() > 2 ?
+                              args[1] : Local<Value>::New(Undefined());
+    Local<Value> js_callback = args.Length() > 2 ? args[2] : args[1];
+
+    return scope.Close(StartScatter(args[0], Local<Array>::New(shardmap->shards),
+                                    js_options, js_callback));
+}
+
+/**
+ * Switches to range routing, shard i takes numeric keys from starts[i]
+ * up to starts[i + 1], the last one takes all keys above its start.
+ * Null switches back to consistent hashing
+ *
+ * @param {Array|null} starts in ascending order, one for each shard
+ */
+Handle<Value> MysqlShardMap::SetRangesSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlShardMap *shardmap = OBJUNWRAP<MysqlShardMap>(args.This());
+
+    if (args.Length() < 1 || args[0]->IsNull() || args[0]->IsUndefined()) {
+        free(shardmap->range_starts);
+        shardmap->range_starts = NULL;
+        return Undefined();
+    }
+
+    if (!args[0]->IsArray() ||
+        Local<Array>::Cast(args[0])->Length() != shardmap->shards_count) {
+        return THRTYPEEXC("Argument 0 must be an array of range starts");
+    }
+
+    Local<Array> js_starts = Local<Array>::Cast(args[0]);
+
+    double *starts = reinterpret_cast<double *>(
+        malloc(shardmap->shards_count*sizeof(double)));
+
+    if (!starts) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    for (uint32_t i = 0; i < shardmap->shards_count; i++) {
+        Local<Value> js_start = js_starts->Get(Integer::New(i));
+
+        if (!js_start->IsNumber() ||
+            (i > 0 && js_start->NumberValue() <= starts[i - 1])) {
+            free(starts);
+            return THRTYPEEXC("Range starts must be ascending numbers");
+        }
+
+        starts[i] = js_start->NumberValue();
+    }
+
+    free(shardmap->range_starts);
+    shardmap->range_starts = starts;
+
+    return Undefined();
+}
+
+/**
+ * Changes shard weights for consistent hashing, queries already sent
+ * to shards finish there. Zero weight drains shard of new keys
+ *
+ * @param {Array} weights
+ */
+Handle<Value> MysqlShardMap::SetWeightsSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlShardMap *shardmap = OBJUNWRAP<MysqlShardMap>(args.This());
+
+    if (args.Length() < 1 || !args[0]->IsArray() ||
+        Local<Array>::Cast(args[0])->Length() != shardmap->shards_count) {
+        return THRTYPEEXC("Argument 0 must be an array of weights");
+    }
+
+    Local<Array> js_weights = Local<Array>::Cast(args[0]);
+
+    for (uint32_t i = 0; i < shardmap->shards_count; i++) {
+        Local<Value> js_weight = js_weights->Get(Integer::New(i));
+        if (!js_weight->IsUint32() ||
+            js_weight->Uint32Value() > SHARDMAP_MAX_WEIGHT) {
+            return THRTYPEEXC("Argument 0 must be an array of weights");
+        }
+    }
+
+    if (!shardmap->BuildRing(js_weights)) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    return Undefined();
+}
+
+/**
+ * Returns index of shard for the key
+ *
+ * @param {String|Number} key
+ * @return {Integer}
+ */
+Handle<Value> MysqlShardMap::ShardSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlShardMap *shardmap = OBJUNWRAP<MysqlShardMap>(args.This());
+
+    if (args.Length() < 1) {
+        return THRTYPEEXC("Argument 0 must be a shard key");
+    }
+
+    const char *error = NULL;
+    int32_t shard = shardmap->Route(args[0], &error);
+
+    if (shard < 0) {
+        return THREXC(error);
+    }
+
+    return scope.Close(Integer::New(shard));
+}
+
@@ -0,0 +1,147 @@
+/*
+Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+See contributors list in README
+
+See license text in LICENSE file
+*/
+
+#ifndef NODE_MYSQL_SHARDMAP_H  // NOLINT
+#define NODE_MYSQL_SHARDMAP_H
+
+#include <v8.h>
+#include <node.h>
+#include <node_events.h>
+
+#include "./mysql_bindings.h"
+#include "./mysql_bindings_connection.h"
+
+using namespace v8; // NOLINT
+
+// Ring points for each unit of shard weight
+#define SHARDMAP_POINTS_PER_WEIGHT 160
+#define SHARDMAP_MAX_WEIGHT 1000
+
+static Persistent<String> shardmap_query_symbol;
+static Persistent<String> shardmap_querySync_symbol;
+static Persistent<String> shardmap_scatter_symbol;
+static Persistent<String> shardmap_setRangesSync_symbol;
+static Persistent<String> shardmap_setWeightsSync_symbol;
+static Persistent<String> shardmap_shardSync_symbol;
+
+class MysqlShardMap : public node::EventEmitter {
+  public:
+    static Persistent<FunctionTemplate> constructor_template;
+
+    static void Init(Handle<Object> target);
+
+  protected:
+    // Connections or pools, anything with query() and querySync() methods
+    Persistent<Array> shards;
+    uint32_t shards_count;
+
+    // Consistent hashing ring, sorted by hash
+    struct ring_point {
+        uint32_t hash;
+        uint32_t shard;
+    };
+    struct ring_point *ring;
+    uint32_t ring_size;
+
+    // First key of each shard, used instead of ring when set
+    double *range_starts;
+
+    MysqlShardMap();
+
+    ~MysqlShardMap();
+
+    static uint32_t Mix(uint32_t hash);
+
+    static uint32_t HashKey(const char *key, size_t length);
+
+    static int CompareRingPoints(const void *a, const void *b);
+
+    bool BuildRing(Local<Array> js_weights);
+
+    int32_t Route(Handle<Value> js_key, const char **error);
+
+    Handle<Value> RouteAndCall(const Arguments& args, const char *method);
+
+    // Constructor
+
+    static Handle<Value> New(const Arguments& args);
+
+    // Methods
+
+    static Handle<Value> Query(const Arguments& args);
+
+    static Handle<Value> QuerySync(const Arguments& args);
+
+#ifndef MYSQL_NON_THREADSAFE
+    struct scatter_order {
+        char *column;
+        int32_t index;
+        bool desc;
+    };
+    struct scatter_request {
+        Persistent<Function> callback;
+        char *query;
+        size_t query_length;
+
+        MysqlConnection **conns;
+        uint32_t conns_count;
+        MYSQL_RES **results;
+        char **errors;
+
+        struct scatter_order *order;
+        uint32_t order_count;
+        uint32_t limit;
+
+        // Workers still running, last one merges results
+        uint32_t running;
+        pthread_mutex_t lock;
+        // After callbacks still to come, main thread only
+        uint32_t pending;
+
+        // Merged rows point into per-shard results
+        MYSQL_ROW *rows;
+        unsigned long *lengths;  // NOLINT (unsigned long required by API)
+        uint32_t rows_count;
+        uint32_t fields_count;
+        char *error;
+    };
+    struct scatter_job {
+        struct scatter_request *scatter;
+        uint32_t index;
+    };
+    static int CompareDecimals(const char *a, unsigned long a_length,  // NOLINT
+                               const char *b, unsigned long b_length);  // NOLINT
+    static int CompareScatterValues(MYSQL_FIELD *field,
+                                    const char *a, unsigned long a_length,  // NOLINT
+                                    const char *b, unsigned long b_length);  // NOLINT
+    static int CompareScatterRows(struct scatter_request *scatter,
+                                  MYSQL_FIELD *fields,
+                                  MYSQL_ROW *current,
+                                  unsigned long **current_lengths,  // NOLINT
+                                  uint32_t a, uint32_t b);
+    static bool IsScatterOrderable(MYSQL_FIELD *field);
+    static void MergeScatter(struct scatter_request *scatter);
+    static void FreeScatter(struct scatter_request *scatter);
+    static int EIO_After_Scatter(eio_req *req);
+    static int EIO_Scatter(eio_req *req);
+#endif
+    static Handle<Value> StartScatter(Local<Value> js_query,
+                                      Local<Value> js_conns,
+                                      Local<Value> js_options,
+                                      Local<Value> js_callback);
+    static Handle<Value> Scatter(const Arguments& args);
+    static Handle<Value> ScatterShards(const Arguments& args);
+
+    static Handle<Value> SetRangesSync(const Arguments& args);
+
+    static Handle<Value> SetWeightsSync(const Arguments& args);
+
+    static Handle<Value> ShardSync(const Arguments& args);
+};
+
+#endif  // NODE_MYSQL_SHARDMAP_H  // NOLINT
+
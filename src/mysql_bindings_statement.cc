@@ -11,6 +11,7 @@
  * @ignore
  */
 #include "./mysql_bindings_connection.h"
+#include "./mysql_bindings_result.h"
 #include "./mysql_bindings_statement.h"
 
 /**
@@ -34,8 +35,22 @@ void MysqlStatement::Init(Handle<Object> target) {
     Local<ObjectTemplate> instance_template =
         constructor_template->InstanceTemplate();
 
+    // Constants
+    NODE_DEFINE_CONSTANT(instance_template, STMT_ATTR_UPDATE_MAX_LENGTH);
+    NODE_DEFINE_CONSTANT(instance_template, STMT_ATTR_CURSOR_TYPE);
+    NODE_DEFINE_CONSTANT(instance_template, STMT_ATTR_PREFETCH_ROWS);
+    NODE_DEFINE_CONSTANT(instance_template, CURSOR_TYPE_NO_CURSOR);
+    NODE_DEFINE_CONSTANT(instance_template, CURSOR_TYPE_READ_ONLY);
+
     // Methods
+    ADD_PROTOTYPE_METHOD(statement, attrGetSync, AttrGetSync);
+    ADD_PROTOTYPE_METHOD(statement, attrSetSync, AttrSetSync);
+    ADD_PROTOTYPE_METHOD(statement, bindParamSync, BindParamSync);
+    ADD_PROTOTYPE_METHOD(statement, execute, Execute);
+    ADD_PROTOTYPE_METHOD(statement, executeBatch, ExecuteBatch);
+    ADD_PROTOTYPE_METHOD(statement, fetchNext, FetchNext);
     ADD_PROTOTYPE_METHOD(statement, prepareSync, PrepareSync);
+    ADD_PROTOTYPE_METHOD(statement, sendLongData, SendLongData);
 
     // Make it visible in JavaScript
     target->Set(String::NewSymbol("MysqlStatement"),
@@ -44,12 +59,212 @@ void MysqlStatement::Init(Handle<Object> target) {
 
 MysqlStatement::MysqlStatement(): EventEmitter() {
     _stmt = NULL;
+    conn = NULL;
+    param_binds = NULL;
+    param_binds_count = 0;
+    long_data_sent = false;
+    result_meta = NULL;
+    result_binds = NULL;
+    result_lengths = NULL;
+    result_nulls = NULL;
+    result_errors = NULL;
+    result_field_count = 0;
+    pending_jobs = 0;
 }
 
 MysqlStatement::~MysqlStatement() {
+    this->FreeResult();
+    FreeParams(param_binds, param_binds_count);
     if (_stmt) {
         mysql_stmt_close(_stmt);
     }
+    if (!js_conn.IsEmpty()) {
+        js_conn.Dispose();
+    }
+}
+
+/**
+ * Fills MYSQL_BIND structure with copy of JavaScript value,
+ * buffer is allocated with malloc() and freed by FreeParams()
+ *
+ * @ignore
+ */
+bool MysqlStatement::BindParam(MYSQL_BIND *bind, Local<Value> js_param) {
+    memset(bind, 0, sizeof(MYSQL_BIND));
+
+    if (js_param->IsNull() || js_param->IsUndefined()) {
+        bind->buffer_type = MYSQL_TYPE_NULL;
+    } else if (js_param->IsBoolean()) {
+        bind->buffer_type = MYSQL_TYPE_TINY;
+        bind->buffer = malloc(sizeof(signed char));
+        if (!bind->buffer) {
+            return false;
+        }
+        *static_cast<signed char *>(bind->buffer) =
+            js_param->BooleanValue() ? 1 : 0;
+    } else if (js_param->IsInt32()) {
+        bind->buffer_type = MYSQL_TYPE_LONGLONG;
+        bind->buffer = malloc(sizeof(int64_t));
+        if (!bind->buffer) {
+            return false;
+        }
+        *static_cast<int64_t *>(bind->buffer) = js_param->IntegerValue();
+    } else if (js_param->IsNumber()) {
+        bind->buffer_type = MYSQL_TYPE_DOUBLE;
+        bind->buffer = malloc(sizeof(double));
+        if (!bind->buffer) {
+            return false;
+        }
+        *static_cast<double *>(bind->buffer) = js_param->NumberValue();
+    } else if (js_param->IsDate()) {
+        time_t rawtime =
+            static_cast<time_t>(js_param->NumberValue()/1000);
+        struct tm timeinfo;
+        if (!localtime_r(&rawtime, &timeinfo)) {
+            return false;
+        }
+        bind->buffer_type = MYSQL_TYPE_DATETIME;
+        bind->buffer = calloc(1, sizeof(MYSQL_TIME));
+        if (!bind->buffer) {
+            return false;
+        }
+        MYSQL_TIME *datetime = static_cast<MYSQL_TIME *>(bind->buffer);
+        datetime->year = timeinfo.tm_year + 1900;
+        datetime->month = timeinfo.tm_mon + 1;
+        datetime->day = timeinfo.tm_mday;
+        datetime->hour = timeinfo.tm_hour;
+        datetime->minute = timeinfo.tm_min;
+        datetime->second = timeinfo.tm_sec;
+        datetime->time_type = MYSQL_TIMESTAMP_DATETIME;
+    } else if (node::Buffer::HasInstance(js_param)) {
+        Local<Object> js_buffer = js_param->ToObject();
+        size_t length = node::Buffer::Length(js_buffer);
+        bind->buffer_type = MYSQL_TYPE_BLOB;
+        // Never allocate zero bytes, malloc(0) may return NULL
+        bind->buffer = malloc(length + 1);
+        if (!bind->buffer) {
+            return false;
+        }
+        memcpy(bind->buffer, node::Buffer::Data(js_buffer), length);
+        bind->buffer_length = length;
+    } else {
+        String::Utf8Value str(js_param->ToString());
+        bind->buffer_type = MYSQL_TYPE_STRING;
+        bind->buffer = malloc(str.length() + 1);
+        if (!bind->buffer) {
+            return false;
+        }
+        memcpy(bind->buffer, *str, str.length());
+        bind->buffer_length = str.length();
+    }
+
+    return true;
+}
+
+/**
+ * Frees buffers allocated by BindParam() and binds array itself
+ *
+ * @ignore
+ */
+void MysqlStatement::FreeParams(MYSQL_BIND *binds, uint32_t count) {
+    if (!binds) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        free(binds[i].buffer);
+    }
+
+    free(binds);
+}
+
+/**
+ * Binds result buffers for statement result set,
+ * must be called with connection query lock held
+ *
+ * @ignore
+ */
+bool MysqlStatement::BindResult() {
+    if (result_binds) {
+        return true;
+    }
+
+    result_meta = mysql_stmt_result_metadata(_stmt);
+    if (!result_meta) {
+        return false;
+    }
+
+    result_field_count = mysql_num_fields(result_meta);
+    MYSQL_FIELD *fields = mysql_fetch_fields(result_meta);
+
+    result_binds = reinterpret_cast<MYSQL_BIND *>(
+        calloc(result_field_count, sizeof(MYSQL_BIND)));
+    result_lengths = reinterpret_cast<unsigned long *>(  // NOLINT
+        calloc(result_field_count, sizeof(unsigned long)));  // NOLINT
+    result_nulls = reinterpret_cast<my_bool *>(
+        calloc(result_field_count, sizeof(my_bool)));
+    result_errors = reinterpret_cast<my_bool *>(
+        calloc(result_field_count, sizeof(my_bool)));
+
+    if (!result_binds || !result_lengths || !result_nulls || !result_errors) {
+        this->FreeResult();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < result_field_count; i++) {
+        // Longer values are truncated here and refetched by column
+        unsigned long length = fields[i].length;  // NOLINT
+        if (length < 64) {
+            length = 64;
+        } else if (length > 4096) {
+            length = 4096;
+        }
+
+        result_binds[i].buffer_type = MYSQL_TYPE_STRING;
+        result_binds[i].buffer = malloc(length);
+        result_binds[i].buffer_length = length;
+        result_binds[i].length = &result_lengths[i];
+        result_binds[i].is_null = &result_nulls[i];
+        result_binds[i].error = &result_errors[i];
+
+        if (!result_binds[i].buffer) {
+            this->FreeResult();
+            return false;
+        }
+    }
+
+    if (mysql_stmt_bind_result(_stmt, result_binds)) {
+        this->FreeResult();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Frees result buffers allocated by BindResult()
+ *
+ * @ignore
+ */
+void MysqlStatement::FreeResult() {
+    if (result_binds) {
+        for (uint32_t i = 0; i < result_field_count; i++) {
+            free(result_binds[i].buffer);
+        }
+        free(result_binds);
+        result_binds = NULL;
+    }
+    free(result_lengths);
+    result_lengths = NULL;
+    free(result_nulls);
+    result_nulls = NULL;
+    free(result_errors);
+    result_errors = NULL;
+    if (result_meta) {
+        mysql_free_result(result_meta);
+        result_meta = NULL;
+    }
+    result_field_count = 0;
 }
 
 /**
@@ -62,14 +277,683 @@ Handle<Value> MysqlStatement::New(const Arguments& args) {
 
     REQ_EXT_ARG(0, js_stmt);
     MYSQL_STMT *stmt = static_cast<MYSQL_STMT*>(js_stmt->Value());
-    MysqlStatement *my_stmt = new MysqlStatement(stmt);
+
+    MysqlConnection *conn = NULL;
+    if (args.Length() > 1 && args[1]->IsObject() &&
+        MysqlConnection::constructor_template->HasInstance(args[1])) {
+        conn = OBJUNWRAP<MysqlConnection>(args[1]->ToObject());
+    }
+
+    MysqlStatement *my_stmt = new MysqlStatement(stmt, conn);
+    if (conn) {
+        // Connection must outlive its statements
+        my_stmt->js_conn = Persistent<Object>::New(args[1]->ToObject());
+    }
     my_stmt->Wrap(args.This());
 
     return args.This();
 }
 
 /**
- * Prepare statement by given query
+ * Gets the current value of a statement attribute
+ *
+ * @param {Integer} attribute
+ * @return {Integer}
+ */
+Handle<Value> MysqlStatement::AttrGetSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlStatement *stmt = OBJUNWRAP<MysqlStatement>(args.This());
+
+    REQ_INT_ARG(0, attr_integer_key)
+    enum_stmt_attr_type attr_key =
+        static_cast<enum_stmt_attr_type>(attr_integer_key);
+
+    switch (attr_key) {
+        case STMT_ATTR_UPDATE_MAX_LENGTH:
+            {
+            my_bool attr_bool_value = 0;
+            if (mysql_stmt_attr_get(stmt->_stmt, attr_key, &attr_bool_value)) {
+                return scope.Close(False());
+            }
+            return scope.Close(attr_bool_value ? True() : False());
+            }
+        case STMT_ATTR_CURSOR_TYPE:
+        case STMT_ATTR_PREFETCH_ROWS:
+            {
+            unsigned long attr_integer_value = 0;  // NOLINT
+            if (mysql_stmt_attr_get(stmt->_stmt, attr_key,
+                                    &attr_integer_value)) {
+                return scope.Close(False());
+            }
+            return scope.Close(Integer::New(attr_integer_value));
+            }
+        default:
+            return THREXC("This attribute isn't supported");
+    }
+}
+
+/**
+ * Sets a statement attribute, e.g. read-only cursor
+ * with STMT_ATTR_CURSOR_TYPE and STMT_ATTR_PREFETCH_ROWS
+ *
+ * @param {Integer} attribute
+ * @param {Integer|Boolean} value
+ * @return {Boolean}
+ */
+Handle<Value> MysqlStatement::AttrSetSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlStatement *stmt = OBJUNWRAP<MysqlStatement>(args.This());
+
+    REQ_INT_ARG(0, attr_integer_key)
+    enum_stmt_attr_type attr_key =
+        static_cast<enum_stmt_attr_type>(attr_integer_key);
+    my_bool r = 1;
+
+    switch (attr_key) {
+        case STMT_ATTR_UPDATE_MAX_LENGTH:
+            {
+            REQ_BOOL_ARG(1, attr_bool_arg)
+            my_bool attr_bool_value = attr_bool_arg ? 1 : 0;
+            r = mysql_stmt_attr_set(stmt->_stmt, attr_key, &attr_bool_value);
+            }
+            break;
+        case STMT_ATTR_CURSOR_TYPE:
+        case STMT_ATTR_PREFETCH_ROWS:
+            {
+            REQ_UINT_ARG(1, attr_uint_arg)
+            unsigned long attr_integer_value = attr_uint_arg;  // NOLINT
+            r = mysql_stmt_attr_set(stmt->_stmt, attr_key,
+                                    &attr_integer_value);
+            }
+            break;
+        default:
+            return THREXC("This attribute isn't supported");
+    }
+
+    if (r) {
+        return scope.Close(False());
+    }
+
+    return scope.Close(True());
+}
+
+/**
+ * Binds parameters for next execute() calls without parameters,
+ * use empty Buffer for parameters sent by sendLongData()
+ *
+ * @param {Array} parameters
+ * @return {Boolean}
+ */
+Handle<Value> MysqlStatement::BindParamSync(const Arguments& args) {
+    HandleScope scope;
+
+    MysqlStatement *stmt = OBJUNWRAP<MysqlStatement>(args.This());
+
+    if (args.Length() < 1 || !args[0]->IsArray()) {
+        return THRTYPEEXC("Argument 0 must be an array");
+    }
+
+    if (!stmt->conn) {
+        return THREXC("Statement is not bound to connection");
+    }
+
+    MYSQLCONN_MUSTNOT_LOAD_STREAM(stmt->conn);
+
+    Local<Array> js_params = Local<Array>::Cast(args[0]);
+    uint32_t param_count = mysql_stmt_param_count(stmt->_stmt);
+
+    if (js_params->Length() != param_count) {
+        return THRTYPEEXC("Parameters must be an array of "
+                          "statement parameters count length");
+    }
+
+    MYSQL_BIND *binds = reinterpret_cast<MYSQL_BIND *>(
+        calloc(param_count + 1, sizeof(MYSQL_BIND)));
+    bool bound = binds != NULL;
+
+    for (uint32_t i = 0; bound && i < param_count; i++) {
+        bound = BindParam(&binds[i], js_params->Get(Integer::New(i)));
+    }
+
+    if (!bound) {
+        FreeParams(binds, param_count);
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    pthread_mutex_lock(&stmt->conn->query_lock);
+    bool r = param_count && mysql_stmt_bind_param(stmt->_stmt, binds);
+    if (!r) {
+        // libmysql reads bound buffers on execute, keep them until rebind
+        FreeParams(stmt->param_binds, stmt->param_binds_count);
+        stmt->param_binds = binds;
+        stmt->param_binds_count = param_count;
+        stmt->long_data_sent = false;
+    }
+    pthread_mutex_unlock(&stmt->conn->query_lock);
+
+    if (r) {
+        FreeParams(binds, param_count);
+        return scope.Close(False());
+    }
+
+    return scope.Close(True());
+}
+
+/**
+ * EIO wrapper functions for MysqlStatement::ExecuteBatch
+ */
+#ifndef MYSQL_NON_THREADSAFE
+int MysqlStatement::EIO_After_ExecuteBatch(eio_req *req) {
+    ev_unref(EV_DEFAULT_UC);
+    HandleScope scope;
+    struct executeBatch_request *batch_req =
+        reinterpret_cast<struct executeBatch_request *>(req->data);
+
+    int argc = batch_req->keep_result ? 1 : 2;
+    Local<Value> argv[2];
+
+    // Affected rows and insert ids are packed into one flat array:
+    // [affected_rows_0, insert_id_0, affected_rows_1, insert_id_1, ...]
+    Local<Array> js_result = Array::New(2*batch_req->rows_done);
+    for (uint32_t i = 0; i < batch_req->rows_done; i++) {
+        js_result->Set(Integer::New(2*i), Number::New(
+            static_cast<double>(batch_req->affected_rows[i])));
+        js_result->Set(Integer::New(2*i + 1), Number::New(
+            static_cast<double>(batch_req->insert_ids[i])));
+    }
+
+    if (req->result) {
+        argv[0] = V8EXC(batch_req->error ?
+                        batch_req->error : "Error on batch execution");
+        argv[0]->ToObject()->Set(V8STR("index"),
+                                 Integer::New(batch_req->rows_done));
+    } else {
+        argv[0] = Local<Value>::New(Null());
+    }
+    argv[1] = js_result;
+
+    batch_req->stmt->pending_jobs--;
+
+    TryCatch try_catch;
+
+    batch_req->callback->Call(Context::GetCurrent()->Global(), argc, argv);
+
+    if (try_catch.HasCaught()) {
+        node::FatalException(try_catch);
+    }
+
+    batch_req->callback.Dispose();
+    batch_req->stmt->Unref();
+    FreeParams(batch_req->binds,
+               batch_req->param_count*batch_req->rows_count);
+    free(batch_req->affected_rows);
+    free(batch_req->insert_ids);
+    free(batch_req->error);
+    free(batch_req);
+
+    return 0;
+}
+
+int MysqlStatement::EIO_ExecuteBatch(eio_req *req) {
+    struct executeBatch_request *batch_req =
+        reinterpret_cast<struct executeBatch_request *>(req->data);
+    MysqlStatement *stmt = batch_req->stmt;
+    MysqlConnection *conn = stmt->conn;
+
+    req->result = 0;
+
+    if (!conn || !conn->_conn) {
+        req->result = 1;
+        return 0;
+    }
+
+    // Whole batch holds the connection, so one job serves all the rows
+    pthread_mutex_lock(&conn->query_lock);
+    for (uint32_t i = 0; i < batch_req->rows_count; i++) {
+        if (batch_req->param_count &&
+            mysql_stmt_bind_param(stmt->_stmt,
+                batch_req->binds + i*batch_req->param_count)) {
+            req->result = 1;
+            break;
+        }
+
+        // Execute consumes long data, even on error
+        stmt->long_data_sent = false;
+
+        if (mysql_stmt_execute(stmt->_stmt)) {
+            req->result = 1;
+            break;
+        }
+
+        batch_req->affected_rows[i] = mysql_stmt_affected_rows(stmt->_stmt);
+        batch_req->insert_ids[i] = mysql_stmt_insert_id(stmt->_stmt);
+
+        // Keep result set (and cursor) open for fetchNext()
+        if (!batch_req->keep_result && mysql_stmt_field_count(stmt->_stmt)) {
+            mysql_stmt_free_result(stmt->_stmt);
+        }
+
+        batch_req->rows_done++;
+    }
+    if (req->result) {
+        batch_req->error = strdup(mysql_stmt_error(stmt->_stmt));
+    }
+    // Batch buffers are freed after callback, restore bindParamSync() ones
+    if (batch_req->param_count && stmt->param_binds) {
+        mysql_stmt_bind_param(stmt->_stmt, stmt->param_binds);
+    }
+    conn->last_activity = ev_time();
+    pthread_mutex_unlock(&conn->query_lock);
+
+    return 0;
+}
+
+/**
+ * Validates and copies parameters arrays and queues execution job
+ *
+ * @ignore
+ */
+Handle<Value> MysqlStatement::QueueExecute(MysqlStatement *stmt,
+                                           Local<Array> js_rows,
+                                           Local<Function> callback,
+                                           bool keep_result,
+                                           bool use_bound_params) {
+    if (!stmt->conn) {
+        return THREXC("Statement is not bound to connection");
+    }
+
+    uint32_t rows_count = js_rows->Length();
+    // Nothing to bind when parameters were bound by bindParamSync()
+    uint32_t param_count = use_bound_params ?
+                           0 : mysql_stmt_param_count(stmt->_stmt);
+
+    if (use_bound_params && !stmt->param_binds &&
+        mysql_stmt_param_count(stmt->_stmt)) {
+        return THREXC("Parameters must be bound by bindParamSync() first");
+    }
+
+    for (uint32_t i = 0; i < rows_count; i++) {
+        Local<Value> js_row = js_rows->Get(Integer::New(i));
+        if (!js_row->IsArray() ||
+            Local<Array>::Cast(js_row)->Length() != param_count) {
+            return THRTYPEEXC("Parameters must be an array of "
+                              "statement parameters count length");
+        }
+    }
+
+    struct executeBatch_request *batch_req =
+        reinterpret_cast<struct executeBatch_request *>(
+            calloc(1, sizeof(struct executeBatch_request)));
+
+    if (!batch_req) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    batch_req->param_count = param_count;
+    batch_req->rows_count = rows_count;
+    batch_req->keep_result = keep_result;
+    batch_req->binds = reinterpret_cast<MYSQL_BIND *>(
+        calloc(param_count*rows_count + 1, sizeof(MYSQL_BIND)));
+    batch_req->affected_rows = reinterpret_cast<my_ulonglong *>(
+        calloc(rows_count + 1, sizeof(my_ulonglong)));
+    batch_req->insert_ids = reinterpret_cast<my_ulonglong *>(
+        calloc(rows_count + 1, sizeof(my_ulonglong)));
+
+    bool bound = batch_req->binds &&
+                 batch_req->affected_rows &&
+                 batch_req->insert_ids;
+
+    // Parameters are copied here, worker thread can't touch V8 heap
+    for (uint32_t i = 0; bound && i < rows_count; i++) {
+        Local<Array> js_row = Local<Array>::Cast(js_rows->Get(Integer::New(i)));
+        for (uint32_t j = 0; bound && j < param_count; j++) {
+            bound = BindParam(&batch_req->binds[i*param_count + j],
+                              js_row->Get(Integer::New(j)));
+        }
+    }
+
+    if (!bound) {
+        FreeParams(batch_req->binds, param_count*rows_count);
+        free(batch_req->affected_rows);
+        free(batch_req->insert_ids);
+        free(batch_req);
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    batch_req->callback = Persistent<Function>::New(callback);
+    batch_req->stmt = stmt;
+
+    MysqlScheduler::Submit(EIO_ExecuteBatch, EIO_After_ExecuteBatch,
+                           stmt->conn ? stmt->conn->priority : EIO_PRI_DEFAULT,
+                           batch_req);
+
+    ev_ref(EV_DEFAULT_UC);
+    stmt->Ref();
+    stmt->pending_jobs++;
+
+    return Undefined();
+}
+#endif
+
+/**
+ * Executes prepared statement, result set stays open
+ * to be read by fetchNext(). Without parameters
+ * it uses ones bound by bindParamSync() and sent by sendLongData()
+ *
+ * @param {Array} parameters (optional)
+ * @param {Function(error)} callback
+ */
+Handle<Value> MysqlStatement::Execute(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    int arg_pos = 0;
+    bool use_bound_params = true;
+    Local<Array> js_rows = Array::New(1);
+
+    if (args.Length() > 0 && args[0]->IsArray()) {
+        js_rows->Set(Integer::New(0), args[0]);
+        use_bound_params = false;
+        arg_pos++;
+    } else {
+        js_rows->Set(Integer::New(0), Array::New());
+    }
+
+    REQ_FUN_ARG(arg_pos, callback);
+
+    MysqlStatement *stmt = OBJUNWRAP<MysqlStatement>(args.This());
+
+    return scope.Close(QueueExecute(stmt, js_rows, callback,
+                                    true, use_bound_params));
+#endif
+}
+
+/**
+ * Executes prepared statement once for every parameters array,
+ * all rows are bound and executed in one worker thread job
+ *
+ * Result is a flat array of affected rows and insert ids pairs:
+ * [affected_rows_0, insert_id_0, affected_rows_1, insert_id_1, ...]
+ * On error it holds executed rows only and error.index
+ * points to the failed parameters array
+ *
+ * @param {Array} array of parameters arrays
+ * @param {Function(error, result)} callback
+ */
+Handle<Value> MysqlStatement::ExecuteBatch(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    if (args.Length() < 1 || !args[0]->IsArray()) {
+        return THRTYPEEXC("Argument 0 must be an array");
+    }
+    REQ_FUN_ARG(1, callback);
+
+    MysqlStatement *stmt = OBJUNWRAP<MysqlStatement>(args.This());
+
+    return scope.Close(QueueExecute(stmt, Local<Array>::Cast(args[0]),
+                                    callback, false, false));
+#endif
+}
+
+/**
+ * EIO wrapper functions for MysqlStatement::FetchNext
+ */
+#ifndef MYSQL_NON_THREADSAFE
+int MysqlStatement::EIO_After_FetchNext(eio_req *req) {
+    ev_unref(EV_DEFAULT_UC);
+    HandleScope scope;
+    struct fetchNext_request *fetch_req =
+        reinterpret_cast<struct fetchNext_request *>(req->data);
+
+    int argc = 1;
+    Local<Value> argv[2];
+
+    uint32_t num_fields = fetch_req->num_fields;
+
+    if (req->result) {
+        argv[0] = V8EXC(fetch_req->error ?
+                        fetch_req->error : "Error on fetching rows");
+    } else {
+        MYSQL_FIELD *fields = mysql_fetch_fields(fetch_req->stmt->result_meta);
+        Local<Array> js_result = Array::New(fetch_req->rows_count);
+        Local<Object> js_result_row;
+
+        for (uint32_t i = 0; i < fetch_req->rows_count; i++) {
+            size_t cell = static_cast<size_t>(i)*num_fields;
+            js_result_row = Object::New();
+
+            for (uint32_t j = 0; j < num_fields; j++) {
+                js_result_row->Set(V8STR(fields[j].name),
+                    MysqlResult::GetFieldValue(fields[j],
+                        fetch_req->cells[cell + j],
+                        fetch_req->lengths[cell + j]));
+            }
+
+            js_result->Set(Integer::New(i), js_result_row);
+        }
+
+        argv[0] = Local<Value>::New(Null());
+        argv[1] = js_result;
+        argc = 2;
+    }
+
+    fetch_req->stmt->pending_jobs--;
+
+    TryCatch try_catch;
+
+    fetch_req->callback->Call(Context::GetCurrent()->Global(), argc, argv);
+
+    if (try_catch.HasCaught()) {
+        node::FatalException(try_catch);
+    }
+
+    fetch_req->callback.Dispose();
+    fetch_req->stmt->Unref();
+    if (fetch_req->cells) {
+        size_t cells_count =
+            static_cast<size_t>(fetch_req->rows_count)*num_fields;
+        for (size_t i = 0; i < cells_count; i++) {
+            free(fetch_req->cells[i]);
+        }
+        free(fetch_req->cells);
+    }
+    free(fetch_req->lengths);
+    free(fetch_req->error);
+    free(fetch_req);
+
+    return 0;
+}
+
+int MysqlStatement::EIO_FetchNext(eio_req *req) {
+    struct fetchNext_request *fetch_req =
+        reinterpret_cast<struct fetchNext_request *>(req->data);
+    MysqlStatement *stmt = fetch_req->stmt;
+    MysqlConnection *conn = stmt->conn;
+
+    req->result = 0;
+
+    if (!conn || !conn->_conn) {
+        req->result = 1;
+        return 0;
+    }
+
+    pthread_mutex_lock(&conn->query_lock);
+
+    if (!stmt->BindResult()) {
+        req->result = 1;
+        fetch_req->error = strdup(mysql_stmt_errno(stmt->_stmt) ?
+                                  mysql_stmt_error(stmt->_stmt) :
+                                  "Statement has no result set");
+        pthread_mutex_unlock(&conn->query_lock);
+        return 0;
+    }
+
+    uint32_t num_fields = stmt->result_field_count;
+    fetch_req->num_fields = num_fields;
+
+    // Cells grow with fetched rows, requested count may be much more
+    // than rows left in result set
+    size_t rows_capacity = 0;
+
+    while (fetch_req->rows_count < fetch_req->rows_requested) {
+        int r = mysql_stmt_fetch(stmt->_stmt);
+
+        if (r == MYSQL_NO_DATA) {
+            break;
+        }
+        if (r == 1) {
+            req->result = 1;
+            fetch_req->error = strdup(mysql_stmt_error(stmt->_stmt));
+            break;
+        }
+
+        if (fetch_req->rows_count == rows_capacity) {
+            size_t new_capacity = rows_capacity ? 2*rows_capacity : 64;
+            if (new_capacity > fetch_req->rows_requested) {
+                new_capacity = fetch_req->rows_requested;
+            }
+
+            char **cells = NULL;
+            unsigned long *lengths = NULL;  // NOLINT
+            if (new_capacity <= (static_cast<size_t>(-1)/sizeof(char *) - 1)/
+                                (num_fields ? num_fields : 1)) {
+                cells = reinterpret_cast<char **>(realloc(fetch_req->cells,
+                    (new_capacity*num_fields + 1)*sizeof(char *)));
+            }
+            if (cells) {
+                memset(cells + rows_capacity*num_fields, 0,
+                       ((new_capacity - rows_capacity)*num_fields + 1)*
+                       sizeof(char *));
+                fetch_req->cells = cells;
+                lengths = reinterpret_cast<unsigned long *>(  // NOLINT
+                    realloc(fetch_req->lengths, (new_capacity*num_fields + 1)*
+                                                sizeof(unsigned long)));  // NOLINT
+            }
+            if (!lengths) {
+                req->result = 1;
+                fetch_req->error = strdup("Could not allocate enough memory");
+                break;
+            }
+
+            memset(lengths + rows_capacity*num_fields, 0,
+                   ((new_capacity - rows_capacity)*num_fields + 1)*
+                   sizeof(unsigned long));  // NOLINT
+            fetch_req->lengths = lengths;
+            rows_capacity = new_capacity;
+        }
+
+        char **row = fetch_req->cells +
+                     static_cast<size_t>(fetch_req->rows_count)*num_fields;
+        unsigned long *row_lengths = fetch_req->lengths +  // NOLINT
+                     static_cast<size_t>(fetch_req->rows_count)*num_fields;
+        fetch_req->rows_count++;
+
+        for (uint32_t j = 0; j < num_fields; j++) {
+            if (stmt->result_nulls[j]) {
+                continue;
+            }
+
+            unsigned long length = stmt->result_lengths[j];  // NOLINT
+            row[j] = reinterpret_cast<char *>(malloc(length + 1));
+            if (!row[j]) {
+                req->result = 1;
+                break;
+            }
+            row_lengths[j] = length;
+
+            if (length > stmt->result_binds[j].buffer_length) {
+                // MYSQL_DATA_TRUNCATED, fetch whole column value
+                MYSQL_BIND column_bind;
+                memset(&column_bind, 0, sizeof(MYSQL_BIND));
+                column_bind.buffer_type = MYSQL_TYPE_STRING;
+                column_bind.buffer = row[j];
+                column_bind.buffer_length = length + 1;
+                if (mysql_stmt_fetch_column(stmt->_stmt, &column_bind, j, 0)) {
+                    req->result = 1;
+                    fetch_req->error = strdup(mysql_stmt_error(stmt->_stmt));
+                    break;
+                }
+            } else {
+                memcpy(row[j], stmt->result_binds[j].buffer, length);
+            }
+            row[j][length] = '\0';
+        }
+
+        if (req->result) {
+            break;
+        }
+    }
+
+    conn->last_activity = ev_time();
+    pthread_mutex_unlock(&conn->query_lock);
+
+    return 0;
+}
+#endif
+
+/**
+ * Fetches next rows of executed statement, with
+ * STMT_ATTR_CURSOR_TYPE = CURSOR_TYPE_READ_ONLY rows are read
+ * from server-side cursor and connection may be used between calls.
+ * Less than requested rows means end of result set
+ *
+ * @param {Integer} rows count
+ * @param {Function(error, rows)} callback
+ */
+Handle<Value> MysqlStatement::FetchNext(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    REQ_UINT_ARG(0, rows_requested);
+    REQ_FUN_ARG(1, callback);
+
+    MysqlStatement *stmt = OBJUNWRAP<MysqlStatement>(args.This());
+
+    if (!stmt->conn) {
+        return THREXC("Statement is not bound to connection");
+    }
+
+    if (rows_requested == 0) {
+        return THRTYPEEXC("Rows count must be positive");
+    }
+
+    struct fetchNext_request *fetch_req =
+        reinterpret_cast<struct fetchNext_request *>(
+            calloc(1, sizeof(struct fetchNext_request)));
+
+    if (!fetch_req) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    fetch_req->callback = Persistent<Function>::New(callback);
+    fetch_req->stmt = stmt;
+    fetch_req->rows_requested = rows_requested;
+
+    MysqlScheduler::Submit(EIO_FetchNext, EIO_After_FetchNext,
+                           stmt->conn ? stmt->conn->priority : EIO_PRI_DEFAULT,
+                           fetch_req);
+
+    ev_ref(EV_DEFAULT_UC);
+    stmt->Ref();
+    stmt->pending_jobs++;
+
+    return Undefined();
+#endif
+}
+
+/**
+ * Prepare statement by given query, throws while execute(),
+ * fetchNext() or sendLongData() of the statement is running
  *
  * @param {String} query
  * @return {Boolean}
@@ -83,10 +967,279 @@ Handle<Value> MysqlStatement::PrepareSync(const Arguments& args) {
 
     int query_len = args[0]->ToString()->Utf8Length();
 
-    if (mysql_stmt_prepare(stmt->_stmt, *query, query_len)) {
+    // Workers and callbacks of these jobs read buffers freed below
+    if (stmt->pending_jobs) {
+        return THREXC("Statement can't be prepared while its "
+                      "execute(), fetchNext() or sendLongData() is running");
+    }
+
+    MysqlConnection *conn = stmt->conn;
+
+    if (conn) {
+        MYSQLCONN_MUSTNOT_LOAD_STREAM(conn);
+        pthread_mutex_lock(&conn->query_lock);
+    }
+
+    // New query means new parameters and result set metadata
+    stmt->FreeResult();
+    FreeParams(stmt->param_binds, stmt->param_binds_count);
+    stmt->param_binds = NULL;
+    stmt->param_binds_count = 0;
+    stmt->long_data_sent = false;
+
+    int r = mysql_stmt_prepare(stmt->_stmt, *query, query_len);
+
+    if (conn) {
+        pthread_mutex_unlock(&conn->query_lock);
+    }
+
+    if (r) {
         return scope.Close(False());
     }
 
     return scope.Close(True());
 }
 
+/**
+ * EIO wrapper functions for MysqlStatement::SendLongData
+ */
+#ifndef MYSQL_NON_THREADSAFE
+int MysqlStatement::EIO_After_SendLongData(eio_req *req) {
+    ev_unref(EV_DEFAULT_UC);
+    HandleScope scope;
+    struct sendLongData_request *long_data_req =
+        reinterpret_cast<struct sendLongData_request *>(req->data);
+
+    Local<Value> argv[1];
+
+    if (req->result) {
+        argv[0] = V8EXC(long_data_req->error ?
+                        long_data_req->error : "Error on sending long data");
+    } else {
+        argv[0] = Local<Value>::New(Null());
+    }
+
+    long_data_req->stmt->pending_jobs--;
+
+    TryCatch try_catch;
+
+    long_data_req->callback->Call(Context::GetCurrent()->Global(), 1, argv);
+
+    if (try_catch.HasCaught()) {
+        node::FatalException(try_catch);
+    }
+
+    long_data_req->callback.Dispose();
+    long_data_req->js_chunks.Dispose();
+    long_data_req->stmt->Unref();
+    for (uint32_t i = 0; i < long_data_req->chunks_count; i++) {
+        if (long_data_req->copied[i]) {
+            free(long_data_req->chunks[i]);
+        }
+    }
+    free(long_data_req->chunks);
+    free(long_data_req->lengths);
+    free(long_data_req->copied);
+    free(long_data_req->error);
+    free(long_data_req);
+
+    return 0;
+}
+
+int MysqlStatement::EIO_SendLongData(eio_req *req) {
+    struct sendLongData_request *long_data_req =
+        reinterpret_cast<struct sendLongData_request *>(req->data);
+    MysqlStatement *stmt = long_data_req->stmt;
+    MysqlConnection *conn = stmt->conn;
+    uint32_t param_number = long_data_req->param_number;
+
+    // One packet per piece keeps chunks under max_allowed_packet
+    const size_t max_piece_length = 1024*1024;
+
+    req->result = 0;
+
+    if (!conn || !conn->_conn) {
+        req->result = 1;
+        return 0;
+    }
+
+    pthread_mutex_lock(&conn->query_lock);
+
+    if (!stmt->param_binds || param_number >= stmt->param_binds_count) {
+        req->result = 1;
+        long_data_req->error = strdup("Parameters must be bound "
+                                      "by bindParamSync() first");
+        pthread_mutex_unlock(&conn->query_lock);
+        return 0;
+    }
+
+    MYSQL_BIND *bind = &stmt->param_binds[param_number];
+    if (bind->buffer_type != MYSQL_TYPE_BLOB &&
+        bind->buffer_type != MYSQL_TYPE_STRING) {
+        // Rebinding drops long data, so it is allowed only before first chunk
+        if (stmt->long_data_sent) {
+            req->result = 1;
+            long_data_req->error = strdup("Parameter must be bound "
+                                          "as Buffer or String");
+            pthread_mutex_unlock(&conn->query_lock);
+            return 0;
+        }
+        free(bind->buffer);
+        memset(bind, 0, sizeof(MYSQL_BIND));
+        bind->buffer_type = MYSQL_TYPE_BLOB;
+        if (mysql_stmt_bind_param(stmt->_stmt, stmt->param_binds)) {
+            req->result = 1;
+            long_data_req->error = strdup(mysql_stmt_error(stmt->_stmt));
+            pthread_mutex_unlock(&conn->query_lock);
+            return 0;
+        }
+    }
+
+    for (uint32_t i = 0; i < long_data_req->chunks_count; i++) {
+        const char *data = long_data_req->chunks[i];
+        size_t length = long_data_req->lengths[i];
+
+        while (length > 0) {
+            size_t piece_length = length < max_piece_length ?
+                                  length : max_piece_length;
+
+            if (mysql_stmt_send_long_data(stmt->_stmt, param_number,
+                                          data, piece_length)) {
+                req->result = 1;
+                long_data_req->error = strdup(mysql_stmt_error(stmt->_stmt));
+                break;
+            }
+            stmt->long_data_sent = true;
+
+            data += piece_length;
+            length -= piece_length;
+        }
+
+        if (req->result) {
+            break;
+        }
+    }
+
+    conn->last_activity = ev_time();
+    pthread_mutex_unlock(&conn->query_lock);
+
+    return 0;
+}
+#endif
+
+/**
+ * Sends parameter data to the server in pieces from a worker thread,
+ * may be called several times before execute().
+ * Buffers are sent as is, without any copy
+ *
+ * @param {Integer} parameter number
+ * @param {Buffer|String|Array} data or array of data chunks
+ * @param {Function(error)} callback
+ */
+Handle<Value> MysqlStatement::SendLongData(const Arguments& args) {
+    HandleScope scope;
+#ifdef MYSQL_NON_THREADSAFE
+    return THREXC(MYSQL_NON_THREADSAFE_ERRORSTRING);
+#else
+    REQ_UINT_ARG(0, param_number);
+    REQ_FUN_ARG(2, callback);
+
+    MysqlStatement *stmt = OBJUNWRAP<MysqlStatement>(args.This());
+
+    if (!stmt->conn) {
+        return THREXC("Statement is not bound to connection");
+    }
+
+    // Own array, so changes to caller's one can't free chunks being sent
+    Local<Array> js_chunks;
+    if (args[1]->IsArray()) {
+        Local<Array> js_data = Local<Array>::Cast(args[1]);
+        js_chunks = Array::New(js_data->Length());
+        for (uint32_t i = 0; i < js_data->Length(); i++) {
+            js_chunks->Set(Integer::New(i), js_data->Get(Integer::New(i)));
+        }
+    } else {
+        js_chunks = Array::New(1);
+        js_chunks->Set(Integer::New(0), args[1]);
+    }
+
+    uint32_t chunks_count = js_chunks->Length();
+    for (uint32_t i = 0; i < chunks_count; i++) {
+        Local<Value> js_chunk = js_chunks->Get(Integer::New(i));
+        if (!js_chunk->IsString() && !node::Buffer::HasInstance(js_chunk)) {
+            return THRTYPEEXC("Argument 1 must be a Buffer, a String "
+                              "or an array of them");
+        }
+    }
+
+    struct sendLongData_request *long_data_req =
+        reinterpret_cast<struct sendLongData_request *>(
+            calloc(1, sizeof(struct sendLongData_request)));
+
+    if (!long_data_req) {
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    long_data_req->chunks = reinterpret_cast<char **>(
+        calloc(chunks_count + 1, sizeof(char *)));
+    long_data_req->lengths = reinterpret_cast<size_t *>(
+        calloc(chunks_count + 1, sizeof(size_t)));
+    long_data_req->copied = reinterpret_cast<bool *>(
+        calloc(chunks_count + 1, sizeof(bool)));
+
+    bool prepared = long_data_req->chunks &&
+                    long_data_req->lengths &&
+                    long_data_req->copied;
+
+    for (uint32_t i = 0; prepared && i < chunks_count; i++) {
+        Local<Value> js_chunk = js_chunks->Get(Integer::New(i));
+        if (node::Buffer::HasInstance(js_chunk)) {
+            Local<Object> js_buffer = js_chunk->ToObject();
+            long_data_req->chunks[i] = node::Buffer::Data(js_buffer);
+            long_data_req->lengths[i] = node::Buffer::Length(js_buffer);
+        } else {
+            String::Utf8Value str(js_chunk->ToString());
+            long_data_req->chunks[i] =
+                reinterpret_cast<char *>(malloc(str.length() + 1));
+            if (!long_data_req->chunks[i]) {
+                prepared = false;
+                break;
+            }
+            memcpy(long_data_req->chunks[i], *str, str.length());
+            long_data_req->lengths[i] = str.length();
+            long_data_req->copied[i] = true;
+        }
+    }
+
+    if (!prepared) {
+        for (uint32_t i = 0; long_data_req->copied && i < chunks_count; i++) {
+            if (long_data_req->copied[i]) {
+                free(long_data_req->chunks[i]);
+            }
+        }
+        free(long_data_req->chunks);
+        free(long_data_req->lengths);
+        free(long_data_req->copied);
+        free(long_data_req);
+        V8::LowMemoryNotification();
+        return THREXC("Could not allocate enough memory");
+    }
+
+    long_data_req->callback = Persistent<Function>::New(callback);
+    long_data_req->js_chunks = Persistent<Array>::New(js_chunks);
+    long_data_req->stmt = stmt;
+    long_data_req->param_number = param_number;
+    long_data_req->chunks_count = chunks_count;
+
+    MysqlScheduler::Submit(EIO_SendLongData, EIO_After_SendLongData,
+                           stmt->conn ? stmt->conn->priority : EIO_PRI_DEFAULT,
+                           long_data_req);
+
+    ev_ref(EV_DEFAULT_UC);
+    stmt->Ref();
+    stmt->pending_jobs++;
+
+    return Undefined();
+#endif
+}
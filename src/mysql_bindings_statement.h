@@ -12,9 +12,19 @@ See license text in LICENSE file
 
 #include <v8.h>
 #include <node.h>
+#include <node_buffer.h>
 #include <node_events.h>
 
+class MysqlConnection;
+
+static Persistent<String> statement_attrGetSync_symbol;
+static Persistent<String> statement_attrSetSync_symbol;
+static Persistent<String> statement_bindParamSync_symbol;
+static Persistent<String> statement_execute_symbol;
+static Persistent<String> statement_executeBatch_symbol;
+static Persistent<String> statement_fetchNext_symbol;
 static Persistent<String> statement_prepareSync_symbol;
+static Persistent<String> statement_sendLongData_symbol;
 
 class MysqlStatement : public node::EventEmitter {
   public:
@@ -22,19 +32,129 @@ class MysqlStatement : public node::EventEmitter {
 
     static void Init(Handle<Object> target);
 
+    static bool BindParam(MYSQL_BIND *bind, Local<Value> js_param);
+
+    static void FreeParams(MYSQL_BIND *binds, uint32_t count);
+
+    bool BindResult();
+
+    void FreeResult();
+
   protected:
     MYSQL_STMT *_stmt;
 
+    MysqlConnection *conn;
+
+    Persistent<Object> js_conn;
+
+    // Parameters bound by bindParamSync(), used by execute() without
+    // parameters and by sendLongData()
+    MYSQL_BIND *param_binds;
+    uint32_t param_binds_count;
+    bool long_data_sent;
+
+    // Result buffers for fetchNext(), every column is fetched as string
+    MYSQL_RES *result_meta;
+    MYSQL_BIND *result_binds;
+    unsigned long *result_lengths;  // NOLINT (unsigned long required by API)
+    my_bool *result_nulls;
+    my_bool *result_errors;
+    uint32_t result_field_count;
+
+    // Asynchronous jobs using buffers above, prepareSync() throws meanwhile
+    uint32_t pending_jobs;
+
     MysqlStatement();
 
-    explicit MysqlStatement(MYSQL_STMT *my_stmt):
-                                    EventEmitter(), _stmt(my_stmt) {}
+    MysqlStatement(MYSQL_STMT *my_stmt, MysqlConnection *my_conn):
+                                    EventEmitter(),
+                                    _stmt(my_stmt),
+                                    conn(my_conn),
+                                    param_binds(NULL),
+                                    param_binds_count(0),
+                                    long_data_sent(false),
+                                    result_meta(NULL),
+                                    result_binds(NULL),
+                                    result_lengths(NULL),
+                                    result_nulls(NULL),
+                                    result_errors(NULL),
+                                    result_field_count(0),
+                                    pending_jobs(0) {}
 
     ~MysqlStatement();
 
     static Handle<Value> New(const Arguments& args);
 
+    static Handle<Value> AttrGetSync(const Arguments& args);
+
+    static Handle<Value> AttrSetSync(const Arguments& args);
+
+    static Handle<Value> BindParamSync(const Arguments& args);
+
+#ifndef MYSQL_NON_THREADSAFE
+    struct executeBatch_request {
+        Persistent<Function> callback;
+        MysqlStatement *stmt;
+
+        MYSQL_BIND *binds;
+        uint32_t param_count;
+        uint32_t rows_count;
+        bool keep_result;
+
+        uint32_t rows_done;
+        my_ulonglong *affected_rows;
+        my_ulonglong *insert_ids;
+        char *error;
+    };
+    static int EIO_After_ExecuteBatch(eio_req *req);
+    static int EIO_ExecuteBatch(eio_req *req);
+    static Handle<Value> QueueExecute(MysqlStatement *stmt,
+                                      Local<Array> js_rows,
+                                      Local<Function> callback,
+                                      bool keep_result,
+                                      bool use_bound_params);
+#endif
+    static Handle<Value> Execute(const Arguments& args);
+
+    static Handle<Value> ExecuteBatch(const Arguments& args);
+
+#ifndef MYSQL_NON_THREADSAFE
+    struct fetchNext_request {
+        Persistent<Function> callback;
+        MysqlStatement *stmt;
+
+        uint32_t rows_requested;
+        uint32_t rows_count;
+        uint32_t num_fields;
+        char **cells;
+        unsigned long *lengths;  // NOLINT (unsigned long required by API)
+        char *error;
+    };
+    static int EIO_After_FetchNext(eio_req *req);
+    static int EIO_FetchNext(eio_req *req);
+#endif
+    static Handle<Value> FetchNext(const Arguments& args);
+
     static Handle<Value> PrepareSync(const Arguments& args);
+
+#ifndef MYSQL_NON_THREADSAFE
+    struct sendLongData_request {
+        Persistent<Function> callback;
+        MysqlStatement *stmt;
+
+        // Keeps Buffer chunks alive while worker reads them
+        Persistent<Array> js_chunks;
+        uint32_t param_number;
+        uint32_t chunks_count;
+        char **chunks;
+        size_t *lengths;
+        bool *copied;
+        char *error;
+    };
+    static int EIO_After_SendLongData(eio_req *req);
+    static int EIO_SendLongData(eio_req *req);
+#endif
+    static Handle<Value> SendLongData(const Arguments& args);
 };
 
 #endif  // NODE_MYSQL_STATEMENT_H  // NOLINT
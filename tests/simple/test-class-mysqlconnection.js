@@ -172,6 +172,65 @@ exports.AffectedRowsSync = function (test) {
   test.done();
 };
 
+exports.BulkInsert = function (test) {
+  test.expect(5);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    rows = [],
+    res,
+    i;
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  res = conn.querySync("DELETE FROM " + cfg.test_table + ";");
+  test.ok(res, "conn.querySync('DELETE FROM cfg.test_table')");
+  
+  for (i = 0; i < cfg.insert_rows_count; i += 1) {
+    rows.push([Math.round(Math.random() * 1000000), (Math.random() > 0.5)]);
+  }
+  rows.push(["42", null]);
+  
+  test.throws(function () {
+    conn.bulkInsert(cfg.test_table, ["random_number", "random_boolean"], [[1]], function () {});
+  }, TypeError, "conn.bulkInsert() with wrong row length");
+  
+  conn.bulkInsert(cfg.test_table, ["random_number", "random_boolean"], rows, function (err, affected_rows) {
+    test.ok(err === null, "conn.bulkInsert() error is null");
+    test.equals(affected_rows, cfg.insert_rows_count + 1, "conn.bulkInsert() affected rows");
+    conn.closeSync();
+    
+    test.done();
+  });
+};
+
+exports.BulkInsertNulls = function (test) {
+  test.expect(3);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    max_allowed_packet = conn.querySync("SELECT @@max_allowed_packet AS p;").fetchAllSync()[0].p,
+    nulls = [null, null, null],
+    rows = [],
+    i;
+  
+  conn.querySync("CREATE TEMPORARY TABLE " + cfg.test_table2 + " (a INT NULL, b INT NULL, c INT NULL);");
+  
+  // Each row takes 17 bytes, enough of them to fill a whole packet
+  for (i = 0; i < Math.ceil(max_allowed_packet / 17) + 100; i += 1) {
+    rows.push(nulls);
+  }
+  
+  conn.bulkInsert(cfg.test_table2, ["a", "b", "c"], rows, function (err, affected_rows) {
+    test.ok(err === null, "conn.bulkInsert() with NULL rows error is null");
+    test.equals(affected_rows, rows.length, "conn.bulkInsert() with NULL rows affected rows");
+    test.equals(conn.querySync("SELECT COUNT(*) AS cnt FROM " + cfg.test_table2 + " WHERE a IS NULL AND c IS NULL;").fetchAllSync()[0].cnt,
+                rows.length, "NULL rows are inserted across packets");
+    conn.closeSync();
+    
+    test.done();
+  });
+};
+
 exports.ChangeUserSync = function (test) {
   test.expect(9);
   
@@ -312,6 +371,35 @@ exports.ErrorSync = function (test) {
   test.done();
 };
 
+exports.EscapeBuffer = function (test) {
+  test.expect(3);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    long_str = new Array(101).join("long string with 'quote' ");
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  test.equals(conn.escapeBuffer(new Buffer("test\nstring \x00")).toString(), "test\\nstring \\0", "conn.escapeBuffer()");
+  test.equals(conn.escapeBuffer(new Buffer(long_str)).toString(), conn.escapeSync(long_str), "conn.escapeBuffer() of long string equals conn.escapeSync()");
+  conn.closeSync();
+  
+  test.done();
+};
+
+exports.EscapeMany = function (test) {
+  test.expect(2);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database);
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  test.same(conn.escapeMany(["test\\string", "test\'string", "Fran\u00e7ais \"Gr\u00f6\u00dfe\""]),
+            ["test\\\\string", "test\\'string", "Fran\u00e7ais \\\"Gr\u00f6\u00dfe\\\""],
+            "conn.escapeMany()");
+  conn.closeSync();
+  
+  test.done();
+};
+
 exports.EscapeSync = function (test) {
   var
     conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
@@ -492,6 +580,153 @@ exports.LastInsertIdSync = function (test) {
   test.done();
 };
 
+exports.LoadData = function (test) {
+  test.expect(4);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(), res, data = "", i;
+  
+  conn.initSync();
+  conn.setOptionSync(conn.MYSQL_OPT_LOCAL_INFILE, 1);
+  conn.realConnectSync(cfg.host, cfg.user, cfg.password, cfg.database);
+  test.ok(conn.connectedSync(), "conn.realConnectSync() with MYSQL_OPT_LOCAL_INFILE");
+  
+  res = conn.querySync("DELETE FROM " + cfg.test_table + ";");
+  test.ok(res, "conn.querySync('DELETE FROM cfg.test_table')");
+  
+  for (i = 0; i < 100; i += 1) {
+    data += i + "\t" + (i % 2) + "\n";
+  }
+  
+  conn.loadData("LOAD DATA LOCAL INFILE 'buffer' INTO TABLE " + cfg.test_table +
+                " (random_number, random_boolean);", new Buffer(data), function (err, affected_rows) {
+    test.ok(err === null, "conn.loadData() error is null");
+    test.equals(affected_rows, 100, "conn.loadData() affected rows");
+    conn.closeSync();
+    
+    test.done();
+  });
+};
+
+exports.LoadDataStream = function (test) {
+  test.expect(7);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(),
+    stream = new (require("events").EventEmitter)(),
+    rows_count = 120000, rows_per_chunk = 1000,
+    chunk = new Buffer(rows_per_chunk * 10),
+    pauses = 0, resumes = 0, i, j, row;
+  
+  conn.initSync();
+  conn.setOptionSync(conn.MYSQL_OPT_LOCAL_INFILE, 1);
+  conn.realConnectSync(cfg.host, cfg.user, cfg.password, cfg.database);
+  test.ok(conn.connectedSync(), "conn.realConnectSync() with MYSQL_OPT_LOCAL_INFILE");
+  
+  conn.querySync("DELETE FROM " + cfg.test_table + ";");
+  
+  stream.pause = function () {
+    pauses += 1;
+  };
+  stream.resume = function () {
+    resumes += 1;
+  };
+  
+  conn.loadData("LOAD DATA LOCAL INFILE 'stream' INTO TABLE " + cfg.test_table +
+                " (random_number, random_boolean);", stream, function (err, affected_rows) {
+    test.ok(err === null, "conn.loadData() error is null");
+    test.equals(affected_rows, rows_count, "conn.loadData() affected rows");
+    test.ok(pauses > 0 && resumes > 0, "Stream is paused while ring buffer is full and resumed");
+    test.equals(conn.querySync("SELECT COUNT(DISTINCT random_number) AS c FROM " + cfg.test_table + ";").fetchAllSync()[0].c,
+                rows_count, "Every chunk is loaded from own copy");
+    test.equals(stream.listeners("data").length, 0, "Listeners are removed");
+    conn.closeSync();
+    
+    test.done();
+  });
+  
+  test.throws(function () {
+    conn.querySync("SELECT 1;");
+  }, Error, "conn.querySync() while loading data from stream");
+  
+  // More than ring buffer size at once from one reused Buffer, ended before the worker drains it
+  for (i = 0; i < rows_count; i += rows_per_chunk) {
+    for (j = 0; j < rows_per_chunk; j += 1) {
+      row = String(10000000 + i + j).substr(1) + "\t" + (j % 2) + "\n";
+      chunk.write(row, j * 10, "ascii");
+    }
+    stream.emit("data", chunk);
+  }
+  stream.emit("end");
+};
+
+exports.LoadDataStreamError = function (test) {
+  test.expect(3);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(),
+    stream = new (require("events").EventEmitter)();
+  
+  conn.initSync();
+  conn.setOptionSync(conn.MYSQL_OPT_LOCAL_INFILE, 1);
+  conn.realConnectSync(cfg.host, cfg.user, cfg.password, cfg.database);
+  test.ok(conn.connectedSync(), "conn.realConnectSync() with MYSQL_OPT_LOCAL_INFILE");
+  
+  conn.loadData("LOAD DATA LOCAL INFILE 'stream' INTO TABLE " + cfg.test_table +
+                " (random_number, random_boolean);", stream, function (err, affected_rows) {
+    test.ok(err instanceof Error, "conn.loadData() error on stream error");
+    test.ok(conn.pingSync(), "Connection is usable after aborted loadData()");
+    conn.closeSync();
+    
+    test.done();
+  });
+  
+  stream.emit("data", new Buffer("1\t1\n"));
+  stream.emit("error", new Error("Source failed"));
+};
+
+exports.Lookup = function (test) {
+  test.expect(8);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    pending = 3, i;
+  
+  conn.querySync("DELETE FROM " + cfg.test_table + ";");
+  for (i = 0; i < 6; i += 1) {
+    conn.querySync("INSERT INTO " + cfg.test_table +
+                   " (random_number, random_boolean) VALUES (" + (i % 3) + ", " + (i % 2) + ");");
+  }
+  
+  function done() {
+    pending -= 1;
+    if (pending === 0) {
+      conn.closeSync();
+      test.done();
+    }
+  }
+  
+  conn.lookup(cfg.test_table, "random_number", 1, function (err, rows) {
+    test.ok(err === null, "conn.lookup() error is null");
+    test.equals(rows.length, 2, "conn.lookup() rows for key 1");
+    test.equals(rows[0].random_number, 1, "conn.lookup() row key value");
+    done();
+  });
+  conn.lookup(cfg.test_table, "random_number", "2", function (err, rows) {
+    test.ok(err === null, "conn.lookup() error is null");
+    test.equals(rows.length, 2, "conn.lookup() rows for key 2");
+    done();
+  });
+  
+  test.throws(function () {
+    conn.lookup(cfg.test_table, "random_number", {}, function () {});
+  }, TypeError, "conn.lookup() with object key");
+  
+  conn.lookup(cfg.test_table, "random_number", 7, function (err, rows) {
+    test.ok(err === null, "conn.lookup() error is null");
+    test.equals(rows.length, 0, "conn.lookup() rows for missing key");
+    done();
+  });
+};
+
 exports.MultiMoreResultsSync = function (test) {
   multiRealQueryAndNextAndMoreSync(test);
 };
@@ -504,6 +739,21 @@ exports.MultiRealQuerySync = function (test) {
   multiRealQueryAndNextAndMoreSync(test);
 };
 
+exports.Ping = function (test) {
+  test.expect(3);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password);
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password)");
+  
+  conn.ping(function (err, rtt) {
+    test.ok(err === null, "conn.ping() error is null");
+    test.ok(rtt >= 0, "conn.ping() round trip time");
+    conn.closeSync();
+    
+    test.done();
+  });
+};
+
 exports.Query = function (test) {
   test.expect(3);
   
@@ -523,6 +773,78 @@ exports.Query = function (test) {
   });
 };
 
+exports.QueryBuffer = function (test) {
+  test.expect(4);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    res;
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  res = conn.querySync(new Buffer("SELECT 'abc' AS str"));
+  test.same(res.fetchAllSync(), [{str: "abc"}], "conn.querySync(buffer) result");
+  
+  conn.query(new Buffer("SELECT 1 AS one"), function (err, result) {
+    test.ok(err === null, "conn.query(buffer) error is null");
+    test.same(result.fetchAllSync(), [{one: 1}], "conn.query(buffer) result");
+    conn.closeSync();
+    test.done();
+  });
+};
+
+exports.QueryCoalesce = function (test) {
+  test.expect(7);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    results = [],
+    done = function (rows) {
+      results.push(rows);
+      if (results.length === 3) {
+        test.ok(results[0] === results[1], "Shared rows are the same array");
+        test.ok(results[2] !== results[0], "Copied rows are own array");
+        test.same(results[2], results[0], "Copied rows are equal to shared ones");
+        conn.closeSync();
+        test.done();
+      }
+    };
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  conn.query("SELECT CONNECTION_ID() AS id, SLEEP(0.5) AS s", {coalesce: true}, function (err, rows) {
+    test.same(rows.length, 1, "Coalesced query gives rows array");
+    done(rows);
+  });
+  conn.query("SELECT CONNECTION_ID() AS id, SLEEP(0.5) AS s", {coalesce: true}, function (err, rows) {
+    test.ok(err === null, "Attached query error is null");
+    done(rows);
+  });
+  conn.query("SELECT CONNECTION_ID() AS id, SLEEP(0.5) AS s", {coalesce: "copy"}, function (err, rows) {
+    test.ok(err === null, "Attached query with copy error is null");
+    done(rows);
+  });
+};
+
+exports.QueryInfo = function (test) {
+  test.expect(6);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    res;
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  res = conn.querySync("DELETE FROM " + cfg.test_table + ";");
+  test.ok(res, "conn.querySync('DELETE FROM cfg.test_table')");
+  
+  conn.query("INSERT INTO " + cfg.test_table + " (random_number, random_boolean) VALUES (1, 1), (2, 0);", function (err, result, info) {
+    test.ok(err === null, "Error object is null");
+    test.equals(info.affectedRows, 2, "info.affectedRows after INSERT");
+    test.equals(info.warningCount, 0, "info.warningCount after INSERT");
+    test.equals(typeof info.info, "string", "info.info after multi-row INSERT");
+    conn.closeSync();
+    test.done();
+  });
+};
+
 exports.QueryWithError = function (test) {
   test.expect(3);
   
@@ -557,6 +879,23 @@ exports.QueryWithQuerySync = function (test) {
   });
 };
 
+exports.QueryWithWarnings = function (test) {
+  test.expect(4);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database);
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  conn.query("DROP TABLE IF EXISTS " + cfg.test_table_notexists + ";", {warnings: true}, function (err, result, info) {
+    test.ok(err === null, "Error object is null");
+    test.equals(info.warningCount, 1, "info.warningCount after DROP TABLE IF EXISTS test_table_notexists");
+    test.same(info.warnings,
+              [{errno: 1051, reason: "Unknown table '" + cfg.test_table_notexists + "'" }],
+              "info.warnings after DROP TABLE IF EXISTS test_table_notexists");
+    conn.closeSync();
+    test.done();
+  });
+};
+
 exports.QuerySync = function (test) {
   test.expect(4);
   
@@ -587,6 +926,24 @@ exports.RealQuerySync = function (test) {
   realQueryAndUseAndStoreResultSync(test);
 };
 
+exports.Reset = function (test) {
+  test.expect(4);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database);
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  test.ok(conn.querySync("SET @reset_test = 1;"), "Set user variable");
+  
+  conn.reset(function (err) {
+    test.ok(err === null, "conn.reset() error is null");
+    test.same(conn.querySync("SELECT @reset_test AS v, DATABASE() AS db;").fetchAllSync(),
+              [{v: null, db: cfg.database}], "User variable is cleared, database is kept");
+    conn.closeSync();
+    
+    test.done();
+  });
+};
+
 exports.SelectDbSync = function (test) {
   test.expect(3);
   
@@ -600,6 +957,22 @@ exports.SelectDbSync = function (test) {
   test.done();
 };
 
+exports.SelectDbSyncAfterUseQuery = function (test) {
+  test.expect(4);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database);
+  test.ok(conn.selectDbSync(cfg.database), "conn.selectDbSync() for current database");
+  
+  conn.querySync("USE information_schema;");
+  test.ok(conn.selectDbSync(cfg.database), "conn.selectDbSync() after USE query");
+  test.same(conn.querySync("SELECT DATABASE() AS db;").fetchAllSync(), [{db: cfg.database}], "Database is switched back");
+  
+  test.ok(conn.autoCommitSync(true), "conn.autoCommitSync() for current mode");
+  conn.closeSync();
+  
+  test.done();
+};
+
 exports.SetCharsetSync = function (test) {
   test.expect(2);
   
@@ -612,6 +985,26 @@ exports.SetCharsetSync = function (test) {
   test.done();
 };
 
+exports.SetKeepaliveSync = function (test) {
+  test.expect(4);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password);
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password)");
+  
+  conn.on("keepalive", function (err, rtt) {
+    test.ok(err === null, "keepalive event error is null");
+    test.ok(rtt >= 0, "keepalive event round trip time");
+    test.ok(conn.setKeepaliveSync(0), "conn.setKeepaliveSync(0)");
+    conn.closeSync();
+    
+    test.done();
+  });
+  conn.setKeepaliveSync(10);
+  
+  // Timer doesn't hold event loop
+  setTimeout(function () {}, 100);
+};
+
 exports.SetOptionSync = function (test) {
   test.expect(2);
   
@@ -636,6 +1029,27 @@ exports.SetOptionSync = function (test) {
   test.done();
 };
 
+exports.SetReconnectSync = function (test) {
+  test.expect(4);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password),
+    conn2 = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password);
+  
+  test.ok(conn.setReconnectSync(true, 3, 10), "conn.setReconnectSync(true, 3, 10)");
+  test.ok(conn.selectDbSync(cfg.database), "conn.selectDbSync(cfg.database)");
+  conn2.querySync("KILL " + conn.threadIdSync() + ";");
+  conn2.closeSync();
+  
+  conn.query("SELECT DATABASE() AS db;", function (err, res) {
+    test.ok(err === null, "conn.query() after connection was killed");
+    test.same(res.fetchAllSync(), [{db: cfg.database}], "Selected database is restored after reconnect");
+    conn.closeSync();
+    
+    test.done();
+  });
+};
+
 exports.SqlStateSync = function (test) {
   test.expect(2);
   
@@ -680,6 +1094,70 @@ exports.ThreadSafeSync = function (test) {
   test.done();
 };
 
+exports.Transaction = function (test) {
+  test.expect(13);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    res;
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  // Test table is MEMORY one, rollback needs transactional engine
+  res = conn.querySync("CREATE TEMPORARY TABLE " + cfg.test_table2 +
+                       " (random_number INT(8) NOT NULL, random_boolean BOOLEAN NOT NULL) ENGINE=InnoDB;");
+  test.ok(res, "conn.querySync('CREATE TEMPORARY TABLE cfg.test_table2 ... ENGINE=InnoDB')");
+  
+  test.throws(function () {
+    conn.transaction([1], function () {});
+  }, TypeError, "conn.transaction() with not string statement");
+  
+  conn.transaction([
+    "INSERT INTO " + cfg.test_table2 + " (random_number, random_boolean) VALUES (1, 1);",
+    "SELECT random_number FROM " + cfg.test_table2
+  ], function (err, results) {
+    test.ok(err === null, "conn.transaction() error is null");
+    test.equals(results[0].affectedRows, 1, "conn.transaction() first statement affected rows");
+    test.same(results[1].fetchAllSync(), [{random_number: 1}], "conn.transaction() second statement result");
+    results[1].freeSync();
+    
+    conn.transaction([
+      "INSERT INTO " + cfg.test_table2 + " (random_number, random_boolean) VALUES (2, 1)",
+      "SELECT * FROM " + cfg.test_table_notexists
+    ], function (err, results) {
+      test.ok(err instanceof Error, "conn.transaction() with failing statement returns error");
+      test.equals(err.index, 1, "conn.transaction() error has failed statement index");
+      
+      res = conn.querySync("SELECT COUNT(*) AS cnt FROM " + cfg.test_table2 + ";");
+      test.equals(res.fetchAllSync()[0].cnt, 1, "conn.transaction() rolled back on error");
+      
+      conn.transaction([
+        "INSERT INTO " + cfg.test_table2 + " (random_number, random_boolean) VALUES (3, 1); " +
+          "INSERT INTO " + cfg.test_table2 + " (random_number, random_boolean) VALUES (4, 1)"
+      ], function (err, results) {
+        test.ok(err instanceof Error, "conn.transaction() with multiple statements in one element");
+        
+        res = conn.querySync("SELECT COUNT(*) AS cnt FROM " + cfg.test_table2 + ";");
+        test.equals(res.fetchAllSync()[0].cnt, 1, "conn.transaction() with multiple statements in one element rolled back");
+        
+        conn.transaction([
+          "INSERT INTO " + cfg.test_table2 + " (random_number, random_boolean) VALUES (5, 1) -- trailing comment",
+          "INSERT INTO " + cfg.test_table2 + " (random_number, random_boolean) VALUES (6, 1) # trailing comment"
+        ], function (err, results) {
+          test.ok(err === null, "conn.transaction() with trailing comments error is null");
+          
+          // Rolled back if COMMIT was commented out and the transaction is left open
+          conn.querySync("ROLLBACK;");
+          res = conn.querySync("SELECT COUNT(*) AS cnt FROM " + cfg.test_table2 + ";");
+          test.equals(res.fetchAllSync()[0].cnt, 3, "conn.transaction() with trailing comments committed");
+          conn.closeSync();
+          
+          test.done();
+        });
+      });
+    });
+  });
+};
+
 exports.UseResultSync = function (test) {
   realQueryAndUseAndStoreResultSync(test);
 };
@@ -0,0 +1,115 @@
+/*
+Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+See contributors list in README
+
+See license text in LICENSE file
+*/
+
+// Load configuration
+var cfg = require("../config").cfg;
+
+// Require modules
+var
+  mysql_libmysqlclient = require("../../mysql-libmysqlclient"),
+  mysql_bindings = require("../../mysql_bindings");
+
+var createPool = function () {
+  return new mysql_bindings.MysqlPool(cfg.host, cfg.user, cfg.password, cfg.database);
+};
+
+exports.New = function (test) {
+  test.expect(1);
+  
+  var pool = createPool();
+  test.ok(pool, "new mysql_bindings.MysqlPool(host, user, password, database)");
+  pool.closeSync();
+  
+  test.done();
+};
+
+exports.Acquire = function (test) {
+  test.expect(6);
+  
+  var pool = createPool();
+  
+  pool.acquire(function (err, conn) {
+    test.ok(err === null, "pool.acquire() error is null");
+    test.ok(conn instanceof mysql_bindings.MysqlConnection, "pool.acquire() gives MysqlConnection");
+    test.ok(conn.querySync("SET @pool_test = 1;"), "Set user variable");
+    pool.release(conn);
+    
+    test.throws(function () {
+      pool.release(conn);
+    }, Error, "pool.release() of already released connection");
+    test.throws(function () {
+      pool.release(mysql_libmysqlclient.createConnectionSync());
+    }, Error, "pool.release() of connection from other place");
+    
+    pool.acquire(function (err, conn2) {
+      test.same(conn2.querySync("SELECT @pool_test AS v;").fetchAllSync(), [{v: null}], "Released connection is reset");
+      pool.release(conn2);
+      pool.closeSync();
+      
+      test.done();
+    });
+  });
+};
+
+exports.Query = function (test) {
+  test.expect(3);
+  
+  var pool = createPool();
+  
+  pool.query("SELECT 1 AS one;", function (err, res) {
+    test.ok(err === null, "pool.query() error is null");
+    test.same(res.fetchAllSync(), [{one: 1}], "pool.query() result");
+    test.equals(pool.statsSync().active, 0, "Connection is released after pool.query()");
+    pool.closeSync();
+    
+    test.done();
+  });
+};
+
+exports.QuerySync = function (test) {
+  test.expect(2);
+  
+  var pool = createPool();
+  
+  pool.setMaxSizeSync(1);
+  test.same(pool.querySync("SELECT 1 AS one;").fetchAllSync(), [{one: 1}], "pool.querySync() result");
+  
+  // The only connection is still being reset
+  test.throws(function () {
+    pool.querySync("SELECT 1 AS one;");
+  }, Error, "pool.querySync() when pool is at max size");
+  pool.closeSync();
+  
+  test.done();
+};
+
+exports.SetSparesSync = function (test) {
+  test.expect(2);
+  
+  var pool = createPool();
+  
+  test.ok(pool.setSparesSync(2), "pool.setSparesSync(2)");
+  test.equals(pool.statsSync().connecting, 2, "Spare connections are opened in background");
+  pool.closeSync();
+  
+  test.done();
+};
+
+exports.Warmup = function (test) {
+  test.expect(3);
+  
+  var pool = createPool();
+  
+  pool.warmup(5, function (err, opened) {
+    test.ok(err === null, "pool.warmup() error is null");
+    test.equals(opened, 5, "pool.warmup() opened connections");
+    test.equals(pool.statsSync().idle, 5, "Warmed up connections are idle");
+    pool.closeSync();
+    
+    test.done();
+  });
+};
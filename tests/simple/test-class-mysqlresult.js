@@ -177,6 +177,59 @@ exports.FetchAllSync = function (test) {
   test.done();
 };
 
+exports.FetchAllSyncCharsets = function (test) {
+  test.expect(5);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    res;
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  res = conn.querySync("SELECT 'ascii' AS a, 'Fran\u00e7ais' AS u, 'a\\0b' AS n;");
+  test.same(res.fetchAllSync(), [{a: "ascii", u: "Fran\u00e7ais", n: "a\u0000b"}], "utf8 values");
+  
+  test.ok(conn.setCharsetSync("latin1"), "conn.setCharsetSync('latin1')");
+  res = conn.querySync("SELECT CONVERT(CONCAT('caf', CHAR(233)) USING latin1) AS s;");
+  test.same(res.fetchAllSync(), [{s: "caf\u00e9"}], "latin1 value");
+  res = conn.querySync("SELECT CONVERT(CONCAT(CHAR(128), CHAR(147), 'x', CHAR(148), CHAR(129)) USING latin1) AS s;");
+  test.same(res.fetchAllSync(), [{s: "\u20ac\u201cx\u201d\u0081"}], "latin1 value with cp1252 characters");
+  
+  conn.closeSync();
+  
+  test.done();
+};
+
+exports.FetchAllSyncColumnsWhere = function (test) {
+  test.expect(6);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    res;
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  res = conn.querySync("SELECT 1 AS a, 'x' AS b, 10 AS c UNION SELECT 2, 'y', 20 UNION SELECT 3, NULL, 30;");
+  test.same(res.fetchAllSync({columns: ["c", 0], where: ["a", ">=", 2]}),
+            [{c: 20, a: 2}, {c: 30, a: 3}], "res.fetchAllSync() with columns and numeric where");
+  
+  res = conn.querySync("SELECT 1 AS a, 'x' AS b, 10 AS c UNION SELECT 2, 'y', 20 UNION SELECT 3, NULL, 30;");
+  test.same(res.fetchAllSync({array: true, columns: [1], where: ["b", "!=", "x"]}),
+            [["y"]], "res.fetchAllSync() with string where skips NULL");
+  
+  res = conn.querySync("SELECT 1 AS a, 'x' AS b, 10 AS c UNION SELECT 2, 'y', 20 UNION SELECT 3, NULL, 30;");
+  test.same(res.fetchAllSync({columns: ["a"], where: ["b", "=", null]}),
+            [{a: 3}], "res.fetchAllSync() with null where");
+  
+  test.throws(function () {
+    res.fetchAllSync({columns: ["nonexistent"]});
+  }, TypeError, "res.fetchAllSync() with unknown column");
+  
+  res = conn.querySync("SELECT 1 AS a, 'x' AS b, 10 AS c UNION SELECT 2, 'y', 20 UNION SELECT 3, NULL, 30;");
+  res.fetchAll({columns: ["b"], where: ["c", "<", 15]}, function (err, rows) {
+    test.same(rows, [{b: "x"}], "res.fetchAll() with columns and where");
+    conn.closeSync();
+    
+    test.done();
+  });
+};
+
 exports.FetchArraySync = function (test) {
   test.expect(5);
   
@@ -400,3 +453,55 @@ exports.NumRowsSync = function (test) {
   test.done();
 };
 
+exports.Serialize = function (test) {
+  test.expect(9);
+  
+  var conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    res,
+    rows,
+    corrupted,
+    i;
+  
+  conn.querySync("DELETE FROM " + cfg.test_table + ";");
+  conn.querySync("INSERT INTO " + cfg.test_table +
+                 " (random_number, random_boolean) VALUES ('1', '1'), ('2', '0');");
+  
+  res = conn.querySync("SELECT random_number, random_boolean, NULL AS nothing FROM " + cfg.test_table +
+                       " ORDER BY random_number;");
+  rows = res.fetchAllSync();
+  
+  res = conn.querySync("SELECT random_number, random_boolean, NULL AS nothing FROM " + cfg.test_table +
+                       " ORDER BY random_number;");
+  res.serialize(function (err, buffer) {
+    test.ok(err === null, "res.serialize() error is null");
+    test.ok(buffer instanceof Buffer, "res.serialize() gives Buffer");
+    
+    var copy = mysql_bindings.MysqlResult.deserializeSync(buffer);
+    test.equals(copy.numRowsSync(), 2, "MysqlResult.deserializeSync(buffer).numRowsSync()");
+    test.same(copy.fetchAllSync(), rows, "MysqlResult.deserializeSync(buffer).fetchAllSync()");
+    test.equals(copy.fetchFieldsSync()[2].name, "nothing", "MysqlResult.deserializeSync(buffer).fetchFieldsSync()");
+    test.same(res.fetchAllSync(), rows, "Result is not changed by res.serialize()");
+    
+    test.throws(function () {
+      mysql_bindings.MysqlResult.deserializeSync(buffer.slice(0, buffer.length - 1));
+    }, Error, "MysqlResult.deserializeSync() with corrupted buffer");
+    
+    // Length of first field name, after 20 bytes header and 6 field numbers, set to NULL
+    corrupted = new Buffer(buffer.length);
+    buffer.copy(corrupted, 0, 0, buffer.length);
+    for (i = 44; i < 48; i += 1) {
+      corrupted[i] = 0xFF;
+    }
+    test.throws(function () {
+      mysql_bindings.MysqlResult.deserializeSync(corrupted);
+    }, Error, "MysqlResult.deserializeSync() with NULL field name");
+    
+    conn.closeSync();
+    
+    test.done();
+  });
+  
+  test.throws(function () {
+    res.freeSync();
+  }, Error, "res.freeSync() while res.serialize() is running");
+};
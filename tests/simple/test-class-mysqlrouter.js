@@ -0,0 +1,117 @@
+/*
+Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+See contributors list in README
+
+See license text in LICENSE file
+*/
+
+// Load configuration
+var cfg = require("../config").cfg;
+
+// Require modules
+var
+  mysql_libmysqlclient = require("../../mysql-libmysqlclient"),
+  mysql_bindings = require("../../mysql_bindings");
+
+var createRouter = function () {
+  var
+    primary = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    replica = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database);
+  
+  return new mysql_bindings.MysqlRouter(primary, [replica]);
+};
+
+var connectionId = function (res) {
+  return res.fetchAllSync()[0].id;
+};
+
+exports.New = function (test) {
+  test.expect(3);
+  
+  test.throws(function () {
+    var router = new mysql_bindings.MysqlRouter();
+  }, TypeError, "new mysql_bindings.MysqlRouter() without primary connection");
+  
+  var router = createRouter();
+  test.ok(router.primary instanceof mysql_bindings.MysqlConnection, "router.primary");
+  test.equals(router.replicas.length, 1, "router.replicas");
+  router.primary.closeSync();
+  router.replicas[0].closeSync();
+  
+  test.done();
+};
+
+exports.Query = function (test) {
+  test.expect(3);
+  
+  var router = createRouter();
+  
+  router.query("SELECT CONNECTION_ID() AS id;", function (err, res) {
+    test.ok(err === null, "router.query() error is null");
+    test.equals(connectionId(res), router.replicas[0].threadIdSync(), "Read is sent to replica");
+    
+    router.query("DELETE FROM " + cfg.test_table + " WHERE 0;", function (err, res) {
+      test.ok(err === null, "Write is sent to primary");
+      router.primary.closeSync();
+      router.replicas[0].closeSync();
+      
+      test.done();
+    });
+  });
+};
+
+exports.QuerySync = function (test) {
+  test.expect(6);
+  
+  var router = createRouter(), primary_id, replica_id;
+  primary_id = router.primary.threadIdSync();
+  replica_id = router.replicas[0].threadIdSync();
+  
+  test.equals(connectionId(router.querySync("SELECT CONNECTION_ID() AS id;")), replica_id, "Read is sent to replica");
+  test.ok(router.querySync("BEGIN;"), "BEGIN is sent to primary");
+  test.equals(connectionId(router.querySync("SELECT CONNECTION_ID() AS id;")), primary_id, "Read in transaction is sent to primary");
+  router.querySync("COMMIT;");
+  test.equals(connectionId(router.querySync("SELECT CONNECTION_ID() AS id;")), replica_id, "Read after transaction is sent to replica");
+  test.equals(connectionId(router.querySync("SELECT CONNECTION_ID() AS id, @v;")), primary_id, "Read with user variable is sent to primary");
+  test.equals(connectionId(router.querySync("SELECT CONNECTION_ID() AS id, 'a@b.com';")), replica_id, "Read with @ in string is sent to replica");
+  router.primary.closeSync();
+  router.replicas[0].closeSync();
+  
+  test.done();
+};
+
+exports.QuerySyncPoolPrimary = function (test) {
+  test.expect(3);
+  
+  var
+    pool = new mysql_bindings.MysqlPool(cfg.host, cfg.user, cfg.password, cfg.database),
+    router = new mysql_bindings.MysqlRouter(pool, []);
+  
+  test.same(router.querySync("SELECT 1 AS one;").fetchAllSync(), [{one: 1}], "Query is sent to pool primary");
+  test.throws(function () {
+    router.querySync("BEGIN;");
+  }, Error, "router.querySync('BEGIN') with pool primary");
+  test.throws(function () {
+    router.query("START TRANSACTION;", function () {});
+  }, Error, "router.query('START TRANSACTION') with pool primary");
+  pool.closeSync();
+  
+  test.done();
+};
+
+exports.SetReadYourWritesSync = function (test) {
+  test.expect(3);
+  
+  var router = createRouter(), primary_id;
+  primary_id = router.primary.threadIdSync();
+  
+  test.ok(router.setReadYourWritesSync(true), "router.setReadYourWritesSync(true)");
+  router.querySync("DELETE FROM " + cfg.test_table + " WHERE 0;");
+  test.equals(connectionId(router.querySync("SELECT CONNECTION_ID() AS id;")), primary_id, "Read after write is sent to primary");
+  router.setReadYourWritesSync(false);
+  test.equals(connectionId(router.querySync("SELECT CONNECTION_ID() AS id;")), router.replicas[0].threadIdSync(), "Read is sent to replica again");
+  router.primary.closeSync();
+  router.replicas[0].closeSync();
+  
+  test.done();
+};
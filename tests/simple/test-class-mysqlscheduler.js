@@ -0,0 +1,88 @@
+/*
+Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+See contributors list in README
+
+See license text in LICENSE file
+*/
+
+// Load configuration
+var cfg = require("../config").cfg;
+
+// Require modules
+var
+  mysql_libmysqlclient = require("../../mysql-libmysqlclient"),
+  mysql_bindings = require("../../mysql_bindings");
+
+exports.LowPriorityLimit = function (test) {
+  test.expect(7);
+  
+  var
+    scheduler = mysql_bindings.MysqlScheduler,
+    batch1 = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    batch2 = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    interactive = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    finished = [],
+    stats,
+    done = function (name) {
+      finished.push(name);
+      if (finished.length === 3) {
+        test.same(finished, ["interactive", "batch1", "batch2"], "Low priority jobs run one at a time after interactive one");
+        test.equals(scheduler.statsSync().lowPriorityRunning, 0, "No low priority jobs left");
+        scheduler.setLowPriorityLimitSync(0);
+        batch1.closeSync();
+        batch2.closeSync();
+        interactive.closeSync();
+        test.done();
+      }
+    };
+  
+  test.throws(function () {
+    batch1.setPrioritySync(scheduler.PRIORITY_MIN - 1);
+  }, TypeError, "conn.setPrioritySync() with out of range priority");
+  
+  scheduler.setLowPriorityLimitSync(1);
+  batch1.setPrioritySync(scheduler.PRIORITY_MIN);
+  batch2.setPrioritySync(scheduler.PRIORITY_MIN);
+  
+  batch1.query("SELECT SLEEP(1)", function (err) {
+    test.ok(err === null, "batch1.query() error is null");
+    done("batch1");
+  });
+  batch2.query("SELECT 1", function (err) {
+    test.ok(err === null, "batch2.query() error is null");
+    done("batch2");
+  });
+  stats = scheduler.statsSync();
+  test.same([stats.lowPriorityRunning, stats.lowPriorityQueued, stats.lowPriorityLimit], [1, 1, 1], "scheduler.statsSync() low priority counters");
+  
+  interactive.query("SELECT 1", {priority: scheduler.PRIORITY_MAX}, function (err) {
+    test.ok(err === null, "interactive.query() error is null");
+    done("interactive");
+  });
+};
+
+exports.ThreadPoolSize = function (test) {
+  test.expect(5);
+  
+  var
+    scheduler = mysql_bindings.MysqlScheduler,
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    stats;
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  test.throws(function () {
+    scheduler.setThreadPoolSizeSync(0);
+  }, TypeError, "scheduler.setThreadPoolSizeSync(0)");
+  
+  scheduler.setThreadPoolSizeSync(2);
+  conn.query("SELECT SLEEP(1)", function (err) {
+    test.ok(err === null, "conn.query() error is null");
+    test.equals(scheduler.statsSync().busyThreads, 0, "No busy threads after query");
+    scheduler.setThreadPoolSizeSync(4);
+    conn.closeSync();
+    test.done();
+  });
+  
+  stats = scheduler.statsSync();
+  test.ok(stats.busyThreads + stats.queueLength === 1, "scheduler.statsSync() gauges while query runs");
+};
@@ -0,0 +1,213 @@
+/*
+Copyright by Oleg Efimov and node-mysql-libmysqlclient contributors
+See contributors list in README
+
+See license text in LICENSE file
+*/
+
+// Load configuration
+var cfg = require("../config").cfg;
+
+// Require modules
+var
+  mysql_libmysqlclient = require("../../mysql-libmysqlclient"),
+  mysql_bindings = require("../../mysql_bindings");
+
+var createShardMap = function () {
+  var
+    shard0 = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    shard1 = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database);
+  
+  return new mysql_bindings.MysqlShardMap([shard0, shard1]);
+};
+
+var closeShards = function (shardmap) {
+  shardmap.shards.forEach(function (shard) {
+    shard.closeSync();
+  });
+};
+
+var connectionId = function (res) {
+  return res.fetchAllSync()[0].id;
+};
+
+exports.New = function (test) {
+  test.expect(4);
+  
+  test.throws(function () {
+    var shardmap = new mysql_bindings.MysqlShardMap();
+  }, TypeError, "new mysql_bindings.MysqlShardMap() without shards");
+  
+  test.throws(function () {
+    var shardmap = new mysql_bindings.MysqlShardMap([{}, {}], [1]);
+  }, TypeError, "new mysql_bindings.MysqlShardMap() with wrong weights count");
+  
+  var shardmap = createShardMap();
+  test.ok(shardmap.shards[0] instanceof mysql_bindings.MysqlConnection, "shardmap.shards");
+  test.equals(shardmap.shards.length, 2, "shardmap.shards.length");
+  closeShards(shardmap);
+  
+  test.done();
+};
+
+exports.Query = function (test) {
+  test.expect(2);
+  
+  var shardmap = createShardMap(), shard = shardmap.shardSync(42);
+  
+  shardmap.query(42, "SELECT CONNECTION_ID() AS id;", function (err, res) {
+    test.ok(err === null, "shardmap.query() error is null");
+    test.equals(connectionId(res), shardmap.shards[shard].threadIdSync(), "Query is sent to key shard");
+    closeShards(shardmap);
+  
+    test.done();
+  });
+};
+
+exports.QuerySync = function (test) {
+  test.expect(2);
+  
+  var shardmap = createShardMap(), shard = shardmap.shardSync("customer-7"), shards = shardmap.shards.slice();
+  
+  test.equals(connectionId(shardmap.querySync("customer-7", "SELECT CONNECTION_ID() AS id;")),
+              shardmap.shards[shard].threadIdSync(), "Query is sent to key shard");
+  
+  // Shard map keeps own copy of shards
+  shardmap.shards.length = 0;
+  test.equals(connectionId(shardmap.querySync("customer-7", "SELECT CONNECTION_ID() AS id;")),
+              shards[shard].threadIdSync(), "Query is sent to key shard after shardmap.shards is emptied");
+  shardmap.shards = shards;
+  closeShards(shardmap);
+  
+  test.done();
+};
+
+exports.Scatter = function (test) {
+  test.expect(6);
+  
+  var shardmap = createShardMap(), shard0 = shardmap.shards[0], shard1 = shardmap.shards[1];
+  
+  shard0.querySync("DELETE FROM " + cfg.test_table + ";");
+  shard0.querySync("INSERT INTO " + cfg.test_table +
+                   " (random_number, random_boolean) VALUES (1, 0), (4, 0), (5, 0), (8, 0);");
+  
+  test.throws(function () {
+    mysql_bindings.MysqlShardMap.scatter("SELECT 1;", [{}], function () {});
+  }, TypeError, "MysqlShardMap.scatter() with non-connection");
+  
+  // Both connections read the same table, so rows come twice
+  mysql_bindings.MysqlShardMap.scatter("SELECT random_number FROM " + cfg.test_table + " ORDER BY random_number DESC LIMIT 3;",
+                                       [shard0, shard1], {orderBy: "random_number DESC", limit: 4}, function (err, rows) {
+    test.ok(err === null, "MysqlShardMap.scatter() error is null");
+    test.same(rows.map(function (row) {
+      return row.random_number;
+    }), [8, 8, 5, 5], "Rows are merged by orderBy with limit");
+    
+    shardmap.scatter("SELECT random_number FROM " + cfg.test_table + " ORDER BY random_number;", {orderBy: ["random_number"]}, function (err, rows) {
+      test.ok(err === null, "shardmap.scatter() error is null");
+      test.equals(rows.length, 8, "shardmap.scatter() rows from all shards");
+      
+      shardmap.scatter("SELECT random_number FROM " + cfg.test_table_notexists + ";", function (err, rows) {
+        test.ok(err instanceof Error && err.shard === 0, "shardmap.scatter() error has shard index");
+        closeShards(shardmap);
+        
+        test.done();
+      });
+    });
+  });
+};
+
+exports.ScatterOrderTypes = function (test) {
+  test.expect(4);
+  
+  var
+    shardmap = createShardMap(),
+    pool = new mysql_bindings.MysqlPool(cfg.host, cfg.user, cfg.password, cfg.database),
+    decimals = "SELECT d, CAST(d AS CHAR) AS s FROM (" +
+               "SELECT CAST('12345678901234567.1' AS DECIMAL(30,1)) AS d UNION ALL " +
+               "SELECT CAST('12345678901234567.2' AS DECIMAL(30,1))) t ORDER BY d DESC;";
+  
+  test.throws(function () {
+    new mysql_bindings.MysqlShardMap([pool]).scatter("SELECT 1 AS one;", function () {});
+  }, TypeError, "shardmap.scatter() with pool shards");
+  pool.closeSync();
+  
+  shardmap.scatter(decimals, {orderBy: "d DESC"}, function (err, rows) {
+    test.ok(err === null, "shardmap.scatter() by DECIMAL error is null");
+    test.same(rows.map(function (row) {
+      return row.s;
+    }), ["12345678901234567.2", "12345678901234567.2", "12345678901234567.1", "12345678901234567.1"],
+              "DECIMAL values are compared exactly");
+    
+    shardmap.scatter("SELECT 'a' AS t ORDER BY t;", {orderBy: "t"}, function (err, rows) {
+      test.ok(err instanceof Error, "shardmap.scatter() by case-insensitive string is error");
+      closeShards(shardmap);
+      
+      test.done();
+    });
+  });
+};
+
+exports.SetRangesSync = function (test) {
+  test.expect(6);
+  
+  var shardmap = new mysql_bindings.MysqlShardMap([{}, {}, {}]);
+  
+  shardmap.setRangesSync([0, 1000, 5000]);
+  test.equals(shardmap.shardSync(0), 0, "First range start");
+  test.equals(shardmap.shardSync(999), 0, "First range end");
+  test.equals(shardmap.shardSync(1000), 1, "Second range start");
+  test.equals(shardmap.shardSync(1000000), 2, "Last range takes all keys above");
+  test.throws(function () {
+    shardmap.shardSync(-1);
+  }, Error, "Key below first range");
+  
+  shardmap.setRangesSync(null);
+  test.ok(shardmap.shardSync(-1) >= 0, "shardmap.setRangesSync(null) restores hashing");
+  
+  test.done();
+};
+
+exports.SetWeightsSync = function (test) {
+  test.expect(3);
+  
+  var shardmap = new mysql_bindings.MysqlShardMap([{}, {}, {}]), before = [], moved = 0, i;
+  
+  for (i = 0; i < 1000; i += 1) {
+    before.push(shardmap.shardSync(i));
+  }
+  
+  shardmap.setWeightsSync([1, 1, 0]);
+  for (i = 0; i < 1000; i += 1) {
+    if (before[i] !== 2 && shardmap.shardSync(i) !== before[i]) {
+      moved += 1;
+    }
+  }
+  test.equals(moved, 0, "Keys of other shards stay in place");
+  test.notEqual(shardmap.shardSync(before.indexOf(2)), 2, "Drained shard gets no keys");
+  
+  test.throws(function () {
+    shardmap.setWeightsSync([0, 0, 0]);
+    shardmap.shardSync(1);
+  }, Error, "No shards with positive weight");
+  
+  test.done();
+};
+
+exports.ShardSync = function (test) {
+  test.expect(3);
+  
+  var shardmap = new mysql_bindings.MysqlShardMap([{}, {}]), counts = [0, 0], i;
+  
+  for (i = 0; i < 1000; i += 1) {
+    counts[shardmap.shardSync("key" + i)] += 1;
+  }
+  test.ok(counts[0] > 300 && counts[1] > 300, "Keys are spread over shards");
+  test.equals(shardmap.shardSync(42), shardmap.shardSync("42"), "Number key is hashed as string");
+  
+  test.throws(function () {
+    shardmap.shardSync({});
+  }, Error, "Object key");
+  
+  test.done();
+};
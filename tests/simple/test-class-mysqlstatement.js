@@ -22,3 +22,146 @@ exports.New = function (test) {
   test.done();
 };
 
+exports.AttrSetSync = function (test) {
+  test.expect(3);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    stmt = conn.initStatementSync();
+  
+  test.ok(stmt.prepareSync("SELECT random_number FROM " + cfg.test_table + ";"), "stmt.prepareSync()");
+  test.ok(stmt.attrSetSync(stmt.STMT_ATTR_CURSOR_TYPE, stmt.CURSOR_TYPE_READ_ONLY), "Set read-only cursor");
+  test.ok(stmt.attrGetSync(stmt.STMT_ATTR_CURSOR_TYPE) === stmt.CURSOR_TYPE_READ_ONLY, "Cursor type is read-only");
+  
+  conn.closeSync();
+  
+  test.done();
+};
+
+exports.BindParamSync = function (test) {
+  test.expect(3);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    stmt = conn.initStatementSync();
+  
+  test.ok(stmt.prepareSync("SELECT ? + ? AS sum;"), "stmt.prepareSync()");
+  test.ok(stmt.bindParamSync([1, 2]), "stmt.bindParamSync([1, 2])");
+  test.throws(function () {
+    stmt.bindParamSync([1]);
+  }, TypeError, "stmt.bindParamSync() with wrong parameters count");
+  
+  conn.closeSync();
+  
+  test.done();
+};
+
+exports.ExecuteBatch = function (test) {
+  test.expect(5);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    stmt;
+  test.ok(conn, "mysql_libmysqlclient.createConnectionSync(host, user, password, database)");
+  
+  conn.querySync("DELETE FROM " + cfg.test_table + ";");
+  
+  stmt = conn.initStatementSync();
+  test.ok(stmt.prepareSync("INSERT INTO " + cfg.test_table +
+                           " (random_number, random_boolean) VALUES (?, ?);"), "stmt.prepareSync()");
+  
+  stmt.executeBatch([[1, true], [2, false], [3, true]], function (err, result) {
+    test.ok(err === null, "stmt.executeBatch() without error");
+    test.same(result, [1, 0, 1, 0, 1, 0], "One affected row per parameters array");
+    test.equals(conn.querySync("SELECT SUM(random_number) AS s FROM " + cfg.test_table + ";").fetchAllSync()[0].s, 6,
+                "All rows are inserted");
+    conn.closeSync();
+    test.done();
+  });
+};
+
+exports.FetchNext = function (test) {
+  test.expect(6);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    stmt = conn.initStatementSync();
+  
+  stmt.prepareSync("SELECT random_number FROM " + cfg.test_table + " WHERE random_number > ? ORDER BY random_number;");
+  stmt.attrSetSync(stmt.STMT_ATTR_CURSOR_TYPE, stmt.CURSOR_TYPE_READ_ONLY);
+  stmt.attrSetSync(stmt.STMT_ATTR_PREFETCH_ROWS, 2);
+  
+  stmt.execute([0], function (err) {
+    test.ok(err === null, "stmt.execute() without error");
+    stmt.fetchNext(2, function (err, rows) {
+      test.ok(err === null, "stmt.fetchNext() without error");
+      test.same(rows, [{random_number: 1}, {random_number: 2}], "First two rows");
+      test.ok(conn.querySync("SELECT 1;"), "Connection is usable between fetches");
+      stmt.fetchNext(2, function (err, rows) {
+        test.ok(err === null, "stmt.fetchNext() without error");
+        test.same(rows, [{random_number: 3}], "Last row");
+        conn.closeSync();
+        test.done();
+      });
+    });
+  });
+};
+
+exports.FetchNextBinary = function (test) {
+  test.expect(3);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    stmt = conn.initStatementSync();
+  
+  stmt.prepareSync("SELECT CONCAT('a', CHAR(0), 'b') AS b;");
+  
+  stmt.execute([], function (err) {
+    test.ok(err === null, "stmt.execute() without error");
+    stmt.fetchNext(1, function (err, rows) {
+      test.same(rows, [{b: "a\u0000b"}], "Value with zero byte is not truncated");
+      conn.closeSync();
+      test.done();
+    });
+  });
+  
+  test.throws(function () {
+    stmt.prepareSync("SELECT 1;");
+  }, Error, "stmt.prepareSync() while stmt.execute() is running");
+};
+
+exports.SendLongData = function (test) {
+  test.expect(4);
+  
+  var
+    conn = mysql_libmysqlclient.createConnectionSync(cfg.host, cfg.user, cfg.password, cfg.database),
+    stmt,
+    chunk = new Buffer(64*1024),
+    chunks,
+    i;
+  
+  for (i = 0; i < chunk.length; i += 1) {
+    chunk[i] = i % 256;
+  }
+  
+  conn.querySync("CREATE TEMPORARY TABLE " + cfg.test_table2 + " (id INT, data LONGBLOB);");
+  
+  stmt = conn.initStatementSync();
+  stmt.prepareSync("INSERT INTO " + cfg.test_table2 + " (id, data) VALUES (?, ?);");
+  test.ok(stmt.bindParamSync([1, null]), "stmt.bindParamSync()");
+  
+  chunks = [chunk, chunk, "tail"];
+  stmt.sendLongData(1, chunks, function (err) {
+    test.ok(err === null, "stmt.sendLongData() without error");
+    stmt.execute(function (err) {
+      test.ok(err === null, "stmt.execute() without error");
+      test.equals(conn.querySync("SELECT LENGTH(data) AS l FROM " + cfg.test_table2 + " WHERE id = 1;").fetchAllSync()[0].l,
+                  2*chunk.length + 4, "All chunks are sent");
+      conn.closeSync();
+      test.done();
+    });
+  });
+  
+  // Chunks are kept by statement, not by this array
+  chunks.length = 0;
+};